@@ -0,0 +1,261 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file b1_density.cc
+/// \brief Density maps of the recoil positions in the output ntuple
+///
+/// Usage: b1_density [-t tree] [-n bins] [-j threads] [-u mm|um|nm]
+///                   [-s selection] [-r xmin xmax ymin ymax zmin zmax]
+///                   [-o output.root] [-p imagePrefix] file.root [file.root ...]
+///
+/// The x_pos, y_pos and z_pos columns of the tree (default Mydata) are
+/// streamed with RDataFrame on j threads (default: all cores) and binned
+/// into the xy, xz and yz projections (TH2D) and a 3D density map (TH3D),
+/// each with n bins per axis (default 200 for the projections, n/4 for the
+/// 3D map). The histograms are written to the output file (default
+/// density.root); with -p the projections are also drawn to
+/// <prefix>_xy.png, <prefix>_xz.png and <prefix>_yz.png. The selection is an
+/// RDataFrame filter expression, e.g. "PKA_E > 0". For the Mydata tree it
+/// defaults to the recoil rows, "PKA_E > 0 || SKA_E > 0": the per-event
+/// energy-deposit rows carry no recoil position and would be binned with
+/// stale or zero coordinates; -s true takes every row. Without -r the range
+/// is taken from a first pass over the data. The memory use depends on the
+/// number of bins only, not on the number of points. An input named
+/// *.manifest (see /b1/output/mergeNtuples) stands for the ntuple files it
+/// lists.
+
+#include "ROOT/RDataFrame.hxx"
+#include "TCanvas.h"
+#include "TFile.h"
+#include "TH2D.h"
+#include "TH3D.h"
+#include "TROOT.h"
+#include "TStyle.h"
+
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace
+{
+
+void PrintUsage()
+{
+  std::cerr
+    << "Usage: b1_density [-t tree] [-n bins] [-j threads] [-u mm|um|nm]\n"
+    << "                  [-s selection] [-r xmin xmax ymin ymax zmin zmax]\n"
+    << "                  [-o output.root] [-p imagePrefix]"
+    << " file.root [file.root ...]" << std::endl;
+}
+
+// widens an empty range, so that a single point still gets a bin
+void Widen(double& min, double& max)
+{
+  if (max > min) return;
+  double half = (min != 0.) ? 0.5 * std::abs(min) : 0.5;
+  min -= half;
+  max += half;
+}
+
+// ROOT bins are [low, high): raises the upper edge by one bin of the finest
+// map, so that the points at the maximum are inside the last bin of every
+// map and not in the overflow
+void IncludeMax(double min, double& max, int nbins)
+{
+  max += (max - min) / nbins;
+}
+
+// adds the ntuple files of a manifest of the B1 output, relative to its
+// directory
+bool AddManifest(const std::string& manifest, std::vector<std::string>& files)
+{
+  std::ifstream in(manifest);
+  if (!in) return false;
+  auto slash = manifest.rfind('/');
+  std::string directory
+    = (slash == std::string::npos) ? "" : manifest.substr(0, slash + 1);
+  std::string line;
+  while (std::getline(in, line)) {
+    std::istringstream fields(line);
+    std::string key, name;
+    fields >> key >> name;
+    if (key == "ntuples") files.push_back(directory + name);
+  }
+  return true;
+}
+
+void Draw(TH2D& histogram, const std::string& fileName)
+{
+  TCanvas canvas("canvas", "", 800, 700);
+  canvas.SetRightMargin(0.15);
+  histogram.Draw("COLZ");
+  canvas.SaveAs(fileName.c_str());
+}
+
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+int main(int argc, char** argv)
+{
+  std::string treeName = "Mydata";
+  std::string selection;
+  std::string unit = "mm";
+  std::string outputName = "density.root";
+  std::string imagePrefix;
+  int nbins = 200;
+  int nThreads = 0;
+  bool hasRange = false;
+  double range[6] = { 0., 0., 0., 0., 0., 0. };
+  std::vector<std::string> inputs;
+
+  for (int i = 1; i < argc; ++i) {
+    std::string arg = argv[i];
+    bool hasValue = (i + 1 < argc);
+    if (arg == "-t" && hasValue) treeName = argv[++i];
+    else if (arg == "-n" && hasValue) nbins = std::atoi(argv[++i]);
+    else if (arg == "-j" && hasValue) nThreads = std::atoi(argv[++i]);
+    else if (arg == "-u" && hasValue) unit = argv[++i];
+    else if (arg == "-s" && hasValue) selection = argv[++i];
+    else if (arg == "-o" && hasValue) outputName = argv[++i];
+    else if (arg == "-p" && hasValue) imagePrefix = argv[++i];
+    else if (arg == "-r" && i + 6 < argc) {
+      for (double& value : range) value = std::atof(argv[++i]);
+      hasRange = true;
+    }
+    else if (!arg.empty() && arg[0] == '-') {
+      PrintUsage();
+      return 1;
+    }
+    else if (arg.size() > 9 && arg.substr(arg.size() - 9) == ".manifest") {
+      if (!AddManifest(arg, inputs)) {
+        std::cerr << "b1_density: cannot read " << arg << std::endl;
+        return 1;
+      }
+    }
+    else inputs.push_back(arg);
+  }
+
+  // the ntuple holds Geant4 internal units, i.e. mm
+  double scale = 1.;
+  if (unit == "um") scale = 1.e3;
+  else if (unit == "nm") scale = 1.e6;
+  else if (unit != "mm") {
+    PrintUsage();
+    return 1;
+  }
+  if (inputs.empty() || nbins < 1) {
+    PrintUsage();
+    return 1;
+  }
+
+  ROOT::EnableImplicitMT(nThreads);
+  gROOT->SetBatch(true);
+
+  ROOT::RDataFrame frame(treeName, inputs);
+  auto toUnit = [scale](double value) { return value * scale; };
+  ROOT::RDF::RNode node = frame;
+  // the event rows of Mydata have no recoil position
+  if (selection.empty() && treeName == "Mydata") {
+    selection = "PKA_E > 0 || SKA_E > 0";
+  }
+  if (!selection.empty()) node = node.Filter(selection);
+  node = node.Define("x", toUnit, { "x_pos" })
+             .Define("y", toUnit, { "y_pos" })
+             .Define("z", toUnit, { "z_pos" });
+
+  if (!hasRange) {
+    // one pass for all six values
+    auto count = node.Count();
+    auto xMin = node.Min("x");
+    auto xMax = node.Max("x");
+    auto yMin = node.Min("y");
+    auto yMax = node.Max("y");
+    auto zMin = node.Min("z");
+    auto zMax = node.Max("z");
+    if (*count == 0) {
+      std::cerr << "b1_density: no points selected" << std::endl;
+      return 1;
+    }
+    range[0] = *xMin;
+    range[1] = *xMax;
+    range[2] = *yMin;
+    range[3] = *yMax;
+    range[4] = *zMin;
+    range[5] = *zMax;
+  }
+  for (int axis = 0; axis < 3; ++axis) {
+    Widen(range[2 * axis], range[2 * axis + 1]);
+    if (!hasRange) IncludeMax(range[2 * axis], range[2 * axis + 1], nbins);
+  }
+
+  const std::string xTitle = "x [" + unit + "]";
+  const std::string yTitle = "y [" + unit + "]";
+  const std::string zTitle = "z [" + unit + "]";
+  const int nbins3 = (nbins >= 4) ? nbins / 4 : 1;
+
+  // booked together, so that the data are read once more
+  auto xy = node.Histo2D(
+    { "density_xy", ("Recoils;" + xTitle + ";" + yTitle).c_str(),
+      nbins, range[0], range[1], nbins, range[2], range[3] }, "x", "y");
+  auto xz = node.Histo2D(
+    { "density_xz", ("Recoils;" + zTitle + ";" + xTitle).c_str(),
+      nbins, range[4], range[5], nbins, range[0], range[1] }, "z", "x");
+  auto yz = node.Histo2D(
+    { "density_yz", ("Recoils;" + zTitle + ";" + yTitle).c_str(),
+      nbins, range[4], range[5], nbins, range[2], range[3] }, "z", "y");
+  auto xyz = node.Histo3D(
+    { "density_xyz", ("Recoils;" + xTitle + ";" + yTitle + ";" + zTitle).c_str(),
+      nbins3, range[0], range[1], nbins3, range[2], range[3],
+      nbins3, range[4], range[5] }, "x", "y", "z");
+
+  TFile output(outputName.c_str(), "RECREATE");
+  if (output.IsZombie()) {
+    std::cerr << "b1_density: cannot create " << outputName << std::endl;
+    return 1;
+  }
+  xy->Write();
+  xz->Write();
+  yz->Write();
+  xyz->Write();
+  output.Close();
+
+  std::cout << "b1_density: " << xy->GetEntries() << " points binned to "
+            << outputName << std::endl;
+
+  if (!imagePrefix.empty()) {
+    gStyle->SetOptStat(0);
+    Draw(*xy, imagePrefix + "_xy.png");
+    Draw(*xz, imagePrefix + "_xz.png");
+    Draw(*yz, imagePrefix + "_yz.png");
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -0,0 +1,119 @@
+#!/usr/bin/env python3
+"""Merges the per-thread output files of example B1 listed in a manifest.
+
+With /b1/output/mergeNtuples false, every worker thread writes its ntuples
+to its own file and the master writes the histograms and <file>.manifest.
+
+  merge_output.py Mydata.manifest [-o merged.root] [-j jobs]
+  merge_output.py Mydata.manifest --list
+
+The first form merges all files of the manifest with ROOT's hadd, which
+runs in parallel with -j (default: the number of files, at most the
+number of cores). The second prints the paths of the ntuple files, one per
+line, for tools that read them as one chain without merging them, e.g.
+a TChain or RDataFrame.
+
+With /b1/output/async the workers write their rows to csv files, listed as
+"rows" in the manifest. The first form concatenates them per ntuple into
+<output>_nt_<ntuple>.csv, keeping the header of the first file; --list
+prints them after the ntuple files.
+"""
+
+import argparse
+import os
+import re
+import shutil
+import subprocess
+import sys
+
+
+def read_manifest(path):
+    """Returns the format, the histogram file, the ntuple and the row files."""
+    directory = os.path.dirname(os.path.abspath(path))
+    fmt = None
+    histograms = None
+    ntuples = []
+    rows = []
+    with open(path) as inp:
+        for line in inp:
+            fields = line.split()
+            if not fields or fields[0].startswith("#"):
+                continue
+            if fields[0] == "format":
+                fmt = fields[1]
+            elif fields[0] == "histograms":
+                histograms = os.path.join(directory, fields[1])
+            elif fields[0] == "ntuples":
+                ntuples.append(os.path.join(directory, fields[1]))
+            elif fields[0] == "rows":
+                rows.append(os.path.join(directory, fields[1]))
+            else:
+                raise ValueError("%s: unknown entry '%s'" % (path, fields[0]))
+    return fmt, histograms, ntuples, rows
+
+
+def concatenate_rows(rows, output_base):
+    """Concatenates the csv row files per ntuple; returns the files written."""
+    by_ntuple = {}
+    for path in rows:
+        # <file>_nt_<ntuple>_t<thread>.csv
+        match = re.search(r"_nt_(.+)_t\d+\.csv$", os.path.basename(path))
+        ntuple = match.group(1) if match else os.path.basename(path)
+        by_ntuple.setdefault(ntuple, []).append(path)
+
+    written = []
+    for ntuple, paths in sorted(by_ntuple.items()):
+        output = "%s_nt_%s.csv" % (output_base, ntuple)
+        with open(output, "w") as out:
+            for index, path in enumerate(paths):
+                with open(path) as inp:
+                    for line in inp:
+                        if index == 0 or not line.startswith("#"):
+                            out.write(line)
+        written.append(output)
+    return written
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n")[0])
+    parser.add_argument("manifest")
+    parser.add_argument("-o", "--output")
+    parser.add_argument("-j", "--jobs", type=int)
+    parser.add_argument("--list", action="store_true")
+    args = parser.parse_args()
+
+    fmt, histograms, ntuples, rows = read_manifest(args.manifest)
+    files = ([histograms] if histograms else []) + ntuples
+    missing = [path for path in files + rows if not os.path.exists(path)]
+    if missing:
+        sys.stderr.write("missing files: %s\n" % " ".join(missing))
+        return 1
+
+    if args.list:
+        for path in ntuples + rows:
+            print(path)
+        return 0
+
+    output = args.output or (os.path.splitext(args.manifest)[0] + "_merged.root")
+    if rows:
+        for path in concatenate_rows(rows, os.path.splitext(output)[0]):
+            print("rows merged into %s" % path)
+        if not ntuples:
+            # the histograms of the master file need no merging
+            return 0
+
+    if fmt != "root":
+        sys.stderr.write("only root files can be merged; use --list\n")
+        return 1
+
+    if shutil.which("hadd") is None:
+        sys.stderr.write("hadd not found; set up ROOT or use --list\n")
+        return 1
+
+    jobs = args.jobs or min(len(files), os.cpu_count() or 1)
+    command = ["hadd", "-f", "-j", str(jobs), output] + files
+    return subprocess.call(command)
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,398 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file b1_bench.cc
+/// \brief Micro-benchmarks of the B1 user-action hot paths
+///
+/// Usage: b1_bench [-i iterations] [-r repetitions] [-p physicsList] [filter]
+///
+/// Every case is run r times with i iterations each; one line per case is
+/// printed in the form
+///   BENCH <case> iterations=<i> repetitions=<r> ns_per_op_min=<t> ns_per_op_median=<t>
+/// Only cases whose name contains the filter string are run.
+
+#include "DetectorConstruction.hh"
+#include "DiamondSD.hh"
+#include "EventAction.hh"
+#include "PrimaryGeneratorAction.hh"
+#include "RandomEngineSelector.hh"
+#include "RunAction.hh"
+#include "SteppingAction.hh"
+
+#include "G4AnalysisManager.hh"
+#include "G4DynamicParticle.hh"
+#include "G4Event.hh"
+#include "G4HCofThisEvent.hh"
+#include "G4IonTable.hh"
+#include "G4Navigator.hh"
+#include "G4ParticleTable.hh"
+#include "G4PhysListFactory.hh"
+#include "G4PhysicalVolumeStore.hh"
+#include "G4RunManager.hh"
+#include "G4SDManager.hh"
+#include "G4Step.hh"
+#include "G4SystemOfUnits.hh"
+#include "G4Track.hh"
+#include "G4UImanager.hh"
+#include "G4UIsession.hh"
+#include "Randomize.hh"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace B1;
+
+namespace
+{
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+/// Swallows the G4cout output of the actions, so that the benchmarks
+/// measure the formatting but not the terminal.
+
+class SilentSession : public G4UIsession
+{
+  public:
+    G4int ReceiveG4cout(const G4String&) override { return 0; }
+    G4int ReceiveG4cerr(const G4String& msg) override
+    {
+      std::cerr << msg;
+      return 0;
+    }
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+struct BenchCase
+{
+  std::string name;
+  std::function<void()> body;
+  std::function<void()> setup = nullptr;     // before the timed loops
+  std::function<void()> teardown = nullptr;  // after them, not timed
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void RunCase(const BenchCase& bench, long iterations, int repetitions)
+{
+  using Clock = std::chrono::steady_clock;
+
+  if (bench.setup) bench.setup();
+
+  // warm up caches and lazily initialised state
+  for (long i = 0; i < iterations / 10 + 1; ++i) bench.body();
+
+  std::vector<double> nsPerOp;
+  for (int r = 0; r < repetitions; ++r) {
+    auto start = Clock::now();
+    for (long i = 0; i < iterations; ++i) bench.body();
+    std::chrono::duration<double, std::nano> elapsed = Clock::now() - start;
+    nsPerOp.push_back(elapsed.count() / iterations);
+  }
+  std::sort(nsPerOp.begin(), nsPerOp.end());
+
+  if (bench.teardown) bench.teardown();
+
+  std::cout << "BENCH " << bench.name
+            << " iterations=" << iterations
+            << " repetitions=" << repetitions
+            << std::fixed << std::setprecision(1)
+            << " ns_per_op_min=" << nsPerOp.front()
+            << " ns_per_op_median=" << nsPerOp[nsPerOp.size() / 2]
+            << std::defaultfloat << std::endl;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+/// A synthetic step of the given particle with the pre-step point located
+/// at pos. The track owns the dynamic particle; the step is owned here.
+
+struct SyntheticStep
+{
+  SyntheticStep(G4Navigator& navigator, const G4ParticleDefinition* particle,
+                G4double energy, const G4ThreeVector& pos, G4int trackID)
+  {
+    navigator.LocateGlobalPointAndSetup(pos, nullptr, false, true);
+    G4TouchableHandle touchable = navigator.CreateTouchableHistory();
+
+    auto dynamicParticle
+      = new G4DynamicParticle(particle, G4ThreeVector(0., 0., 1.), energy);
+    track = new G4Track(dynamicParticle, 0., pos);
+    track->SetTrackID(trackID);
+    track->SetParentID(trackID > 1 ? 1 : 0);
+    track->SetTouchableHandle(touchable);
+    track->SetVertexKineticEnergy(energy);
+
+    step = new G4Step();
+    step->InitializeStep(track);
+    track->SetStep(step);
+    step->GetPostStepPoint()->SetPosition(pos + G4ThreeVector(0., 0., 1.*nm));
+    step->SetTotalEnergyDeposit(0.1*energy);
+  }
+
+  ~SyntheticStep()
+  {
+    delete step;
+    delete track;
+  }
+
+  G4Track* track = nullptr;
+  G4Step* step = nullptr;
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+/// One recoil row as filled by EventAction from a recoil hit
+
+void FillRow(OutputWriter& output)
+{
+  for (G4int col = 1; col < 8; ++col) output.FillNtupleDColumn(col, 1.*col);
+  output.FillNtupleIColumn(8, 2);
+  output.FillNtupleIColumn(9, 0);
+  output.AddNtupleRow();
+}
+
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+int main(int argc, char** argv)
+{
+  long iterations = 100000;
+  int repetitions = 5;
+  G4String physListName = "FTFP_BERT";
+  std::string filter;
+
+  for (int i = 1; i < argc; ++i) {
+    std::string arg = argv[i];
+    if (arg == "-i" && i + 1 < argc) iterations = std::atol(argv[++i]);
+    else if (arg == "-r" && i + 1 < argc) repetitions = std::atoi(argv[++i]);
+    else if (arg == "-p" && i + 1 < argc) physListName = argv[++i];
+    else filter = arg;
+  }
+  if (iterations < 1) iterations = 1;
+  if (repetitions < 1) repetitions = 1;
+
+  SilentSession session;
+  G4UImanager::GetUIpointer()->SetCoutDestination(&session);
+
+  // Geometry and particles are set up by a regular initialisation; the
+  // physics tables are not built since no run is started.
+  auto runManager = new G4RunManager;
+  auto detector = new DetectorConstruction();
+  runManager->SetUserInitialization(detector);
+  G4PhysListFactory physListFactory;
+  G4VModularPhysicsList* physicsList
+    = physListFactory.GetReferencePhysList(physListName);
+  physicsList->SetVerboseLevel(0);
+  runManager->SetUserInitialization(physicsList);
+  runManager->Initialize();
+
+  // The actions are used directly, they are not registered in the kernel.
+  auto runAction = new RunAction();
+  auto generatorAction = new PrimaryGeneratorAction();
+  auto eventAction = new EventAction(runAction);
+  auto steppingAction = new SteppingAction(eventAction);
+
+  auto analysisManager = G4AnalysisManager::Instance();
+  analysisManager->SetVerboseLevel(0);
+  const G4String benchFile = "b1_bench.root";
+  analysisManager->OpenFile(benchFile);
+
+  G4Navigator navigator;
+  navigator.SetWorldVolume(
+    G4PhysicalVolumeStore::GetInstance()->GetVolume("World"));
+
+  const G4ParticleDefinition* carbon
+    = G4IonTable::GetIonTable()->GetIon(6, 12, 0.);
+  const G4ParticleDefinition* proton
+    = G4ParticleTable::GetParticleTable()->FindParticle("proton");
+
+  // inside the diamond and in the vacuum envelope in front of it
+  G4ThreeVector inDiamond(0., 0., 0.01*cm);
+  G4ThreeVector inEnvelope(0., 0., -0.01*cm);
+
+  SyntheticStep recoilStep(navigator, carbon, 50.*keV, inDiamond, 2);
+  SyntheticStep protonStep(navigator, proton, 24.*GeV, inDiamond, 1);
+  SyntheticStep vacuumStep(navigator, proton, 24.*GeV, inEnvelope, 1);
+
+  // the recoil is a secondary of the primary, as for the tracking action
+  auto& ancestry = eventAction->GetAncestry();
+  ancestry.AddTrack(protonStep.track);
+  ancestry.AddTrack(recoilStep.track);
+
+  // the scoring of the diamond, as registered by ConstructSDandField(); the
+  // recoil is a C12 secondary at its first step
+  auto sdManager = G4SDManager::GetSDMpointer();
+  auto diamondSD
+    = static_cast<DiamondSD*>(sdManager->FindSensitiveDetector("DiamondSD"));
+  SyntheticStep sdRecoilStep(navigator, carbon, 50.*keV, inDiamond, 3);
+  sdRecoilStep.track->IncrementCurrentStepNumber();
+  G4HCofThisEvent* openHCE = nullptr;
+
+  G4Event event;
+
+  std::vector<BenchCase> cases = {
+    { "stepping/outside_scoring_volume",
+      [&]() { steppingAction->UserSteppingAction(vacuumStep.step); } },
+    { "stepping/primary_in_diamond",
+      [&]() { steppingAction->UserSteppingAction(protonStep.step); } },
+    { "stepping/recoil_in_diamond",
+      [&]() { steppingAction->UserSteppingAction(recoilStep.step); } },
+    // the energy deposit path since the hits collections: the stepping
+    // cases above no longer score the deposit
+    { "sd/deposit_step",
+      [&]() { diamondSD->ProcessHits(protonStep.step, nullptr); },
+      [&]() {
+        openHCE = new G4HCofThisEvent(sdManager->GetCollectionCapacity());
+        diamondSD->Initialize(openHCE);
+      },
+      [&]() {
+        diamondSD->EndOfEvent(openHCE);
+        delete openHCE;
+      } },
+    { "sd/recoil_step",
+      [&]() { diamondSD->ProcessHits(sdRecoilStep.step, nullptr); },
+      [&]() {
+        openHCE = new G4HCofThisEvent(sdManager->GetCollectionCapacity());
+        diamondSD->Initialize(openHCE);
+      },
+      [&]() {
+        diamondSD->EndOfEvent(openHCE);
+        delete openHCE;
+      } },
+    // one event: 100 deposit steps and one recoil, then the hits loop of
+    // the event action, which fills the recoil histograms and row
+    { "sd/event_100_deposits_1_recoil",
+      [&]() {
+        auto hce = new G4HCofThisEvent(sdManager->GetCollectionCapacity());
+        eventAction->BeginOfEventAction(&event);
+        ancestry.AddTrack(protonStep.track);
+        ancestry.AddTrack(sdRecoilStep.track);
+        diamondSD->Initialize(hce);
+        for (G4int i = 0; i < 100; ++i) {
+          diamondSD->ProcessHits(protonStep.step, nullptr);
+        }
+        diamondSD->ProcessHits(sdRecoilStep.step, nullptr);
+        diamondSD->EndOfEvent(hce);
+        event.SetHCofThisEvent(hce);
+        eventAction->EndOfEventAction(&event);
+        event.SetHCofThisEvent(nullptr);
+        delete hce;
+      } },
+    { "generator/energy_from_spectrum",
+      [&]() { generatorAction->GetEnergyFromSpectrum(); } },
+    { "generator/energy_from_table",
+      [&]() { generatorAction->GetEnergyFromTable(); } },
+    { "generator/generate_primaries",
+      [&]() {
+        G4Event anEvent;
+        generatorAction->GeneratePrimaries(&anEvent);
+      } },
+    { "event/end_of_event",
+      [&]() {
+        eventAction->BeginOfEventAction(&event);
+        eventAction->AddEdep(1.*MeV);
+        eventAction->EndOfEventAction(&event);
+      } },
+    { "output/fill_h1",
+      [&]() { analysisManager->FillH1(1, 10.*keV); } },
+    { "output/fill_ntuple_row",
+      [&]() {
+        for (G4int col = 0; col < 8; ++col) {
+          analysisManager->FillNtupleDColumn(col, 1.*col);
+        }
+        analysisManager->FillNtupleIColumn(8, 2);
+        analysisManager->FillNtupleIColumn(9, 0);
+        analysisManager->AddNtupleRow();
+      } },
+    { "output/writer_row_sync",
+      [&]() { FillRow(runAction->GetOutput()); } },
+    { "output/writer_row_async",
+      [&]() { FillRow(runAction->GetOutput()); },
+      [&]() {
+        G4UImanager::GetUIpointer()->ApplyCommand("/b1/output/async true");
+        G4UImanager::GetUIpointer()->ApplyCommand("/b1/output/file b1_bench");
+        runAction->GetOutput().BeginOfRun();
+        runAction->GetOutput().StartWriter();
+      },
+      [&]() {
+        runAction->GetOutput().EndOfRun();
+        G4UImanager::GetUIpointer()->ApplyCommand("/b1/output/async false");
+      } }
+  };
+
+  // 64 uniform numbers per iteration, one at a time and as one block
+  const G4int nRandom = 64;
+  std::vector<G4double> randomBuffer(nRandom);
+  std::unique_ptr<CLHEP::HepRandomEngine> engine;
+  std::istringstream engineNames(RandomEngineSelector::GetEngineNames());
+  std::string engineName;
+  while (engineNames >> engineName) {
+    auto setup = [&engine, engineName]() {
+      engine.reset(RandomEngineSelector::CreateEngine(engineName));
+    };
+    cases.push_back({ "random/" + engineName + "/flat_x64",
+                      [&]() {
+                        G4double sum = 0.;
+                        for (G4int i = 0; i < nRandom; ++i) sum += engine->flat();
+                        randomBuffer[0] = sum;
+                      },
+                      setup });
+    cases.push_back({ "random/" + engineName + "/flat_array_x64",
+                      [&]() { engine->flatArray(nRandom, randomBuffer.data()); },
+                      setup });
+  }
+
+  for (const auto& bench : cases) {
+    if (!filter.empty() && bench.name.find(filter) == std::string::npos) {
+      continue;
+    }
+    RunCase(bench, iterations, repetitions);
+  }
+
+  analysisManager->Write();
+  analysisManager->CloseFile();
+  std::remove(benchFile.c_str());
+
+  delete steppingAction;
+  delete eventAction;
+  delete generatorAction;
+  delete runAction;
+  G4UImanager::GetUIpointer()->SetCoutDestination(nullptr);
+  delete runManager;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -29,11 +29,16 @@
 
 #include "DetectorConstruction.hh"
 #include "ActionInitialization.hh"
+#include "RandomEngineSelector.hh"
+#include "WorkerInitialization.hh"
+#include "G4MTRunManager.hh"
 #include "G4PhysListFactory.hh"
 #include "G4RunManagerFactory.hh"
 #include "G4SteppingVerbose.hh"
 #include "G4UImanager.hh"
+#include "G4UIcommand.hh"
 #include "G4EmStandardPhysics.hh"
+#include "G4FastSimulationPhysics.hh"
 #include "QBBC.hh"
 #include "FTFP_BERT_HP.hh"
 #include "QGSP_BERT_HP.hh"
@@ -46,27 +51,77 @@
 
 using namespace B1;
 
+namespace
+{
+  void PrintUsage()
+  {
+    G4cerr << " Usage: " << G4endl
+           << " exampleB1 [-m macro] [-r serial|mt|tasking] [-t nThreads]"
+           << " [-g eventsPerTask]" << G4endl
+           << " exampleB1 macro" << G4endl;
+  }
+}
+
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
 int main(int argc,char** argv)
 {
-  // Detect interactive mode (if no arguments) and define UI session
+  // Evaluate arguments
+  //
+  G4String macro;
+  G4String runType = "serial";
+  G4int nThreads = 0;
+  G4int eventsPerTask = 0;
+  for (G4int i = 1; i < argc; ++i) {
+    G4String arg = argv[i];
+    G4bool hasValue = (i + 1 < argc);
+    if (arg == "-m" && hasValue) macro = argv[++i];
+    else if (arg == "-r" && hasValue) runType = argv[++i];
+    else if (arg == "-t" && hasValue) nThreads = G4UIcommand::ConvertToInt(argv[++i]);
+    else if (arg == "-g" && hasValue) eventsPerTask = G4UIcommand::ConvertToInt(argv[++i]);
+    else if (argc == 2) macro = arg;
+    else {
+      PrintUsage();
+      return 1;
+    }
+  }
+
+  G4RunManagerType managerType;
+  if (runType == "serial") managerType = G4RunManagerType::SerialOnly;
+  else if (runType == "mt") managerType = G4RunManagerType::MTOnly;
+  else if (runType == "tasking") managerType = G4RunManagerType::TaskingOnly;
+  else {
+    PrintUsage();
+    return 1;
+  }
+
+  // Detect interactive mode (if no macro) and define UI session
   //
   G4UIExecutive* ui = nullptr;
-  if ( argc == 1 ) { ui = new G4UIExecutive(argc, argv); }
+  if ( macro.empty() ) { ui = new G4UIExecutive(argc, argv); }
 
   // Optionally: choose a different Random engine...
   // G4Random::setTheEngine(new CLHEP::MTwistEngine);
+  // or with /b1/random/engine before /run/initialize
+  auto engineSelector = new RandomEngineSelector;
 
   //use G4SteppingVerboseWithUnits
   G4int precision = 4;
   G4SteppingVerbose::UseBestUnit(precision);
 
-  // Construct the default run manager
+  // Construct the run manager: sequential by default, -r mt for the static
+  // event distribution of G4MTRunManager, -r tasking for the task queue of
+  // G4TaskRunManager, where idle threads take the next task
   //
-  G4RunManager* runManager = new G4RunManager;
-  runManager->SetNumberOfThreads(1);  //auto* runManager =
-    //G4RunManagerFactory::CreateRunManager(G4RunManagerType::Default);
+  auto* runManager = G4RunManagerFactory::CreateRunManager(managerType);
+  if (managerType != G4RunManagerType::SerialOnly) {
+    if (nThreads > 0) runManager->SetNumberOfThreads(nThreads);
+    // number of events a thread takes at once (0: let Geant4 choose)
+    if (eventsPerTask > 0) {
+      static_cast<G4MTRunManager*>(runManager)->SetEventModulo(eventsPerTask);
+    }
+    runManager->SetUserInitialization(new WorkerInitialization);
+  }
 
   // Set mandatory initialization classes
   //
@@ -79,6 +134,14 @@ int main(int argc,char** argv)
   G4PhysListFactory physListFactory;
   G4VModularPhysicsList* physicsList = physListFactory.GetReferencePhysList(physListName);
   physicsList->SetVerboseLevel(0);
+
+  // fast simulation process for the VacuumTransportModel of the envelope
+  auto fastSimulationPhysics = new G4FastSimulationPhysics();
+  for (const auto& name : { "proton", "neutron", "gamma", "e-", "e+",
+                            "pi+", "pi-", "deuteron", "alpha", "GenericIon" }) {
+    fastSimulationPhysics->ActivateFastSimulation(name);
+  }
+  physicsList->RegisterPhysics(fastSimulationPhysics);
   runManager->SetUserInitialization(physicsList);
 
 // 把这个名字传给 ActionInitialization
@@ -102,8 +165,7 @@ int main(int argc,char** argv)
   if ( ! ui ) {
     // batch mode
     G4String command = "/control/execute ";
-    G4String fileName = argv[1];
-    UImanager->ApplyCommand(command+fileName);
+    UImanager->ApplyCommand(command+macro);
   }
   else {
     // interactive mode
@@ -119,6 +181,7 @@ int main(int argc,char** argv)
 
   delete visManager;
   delete runManager;
+  delete engineSelector;
 }
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo.....
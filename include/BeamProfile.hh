@@ -0,0 +1,100 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file BeamProfile.hh
+/// \brief Definition of the B1::BeamProfile class
+
+#ifndef B1BeamProfile_h
+#define B1BeamProfile_h 1
+
+#include "G4ThreeVector.hh"
+#include "globals.hh"
+
+class G4GenericMessenger;
+
+/// Transverse profile and divergence of the primary beam.
+///
+/// The profile is selected with /b1/gun/profile:
+///  - pencil:   all primaries at the centre,
+///  - gaussian: x and y normal with the given sigma,
+///  - square:   uniform over a square of the given full width (default,
+///              100 nm as in the original generator),
+///  - disk:     uniform over a disk of the given diameter,
+///  - raster:   the centres of an N x N grid over the square, visited in
+///              order of the event ID.
+/// The direction is +z, tilted by a normal angle of the given sigma in x
+/// and in y when /b1/gun/divergence is set. Derived quantities are
+/// recomputed only after a command changed a parameter.
+
+namespace B1
+{
+
+class RandomBatch;
+
+class BeamProfile
+{
+  public:
+    BeamProfile();
+    ~BeamProfile();
+
+    void Generate(RandomBatch& random, G4int eventID,
+                  G4ThreeVector& position, G4ThreeVector& direction);
+
+    // uniform numbers taken from the batch by one Generate()
+    G4int NumbersPerEvent() const;
+
+  private:
+    enum class Shape { kPencil, kGaussian, kSquare, kDisk, kRaster };
+
+    void Update();
+    void SetProfile(const G4String& name);
+    void SetCentre(const G4ThreeVector& centre) { fCentre = centre; }
+    void SetSize(G4double size) { fSize = size; fDirty = true; }
+    void SetSigma(G4double sigma) { fSigma = sigma; }
+    void SetDivergence(G4double sigma) { fDivergence = sigma; }
+    void SetRasterPoints(G4int n) { fRasterPoints = n; fDirty = true; }
+    void DefineCommands();
+
+    G4GenericMessenger* fMessenger = nullptr;
+    Shape fShape = Shape::kSquare;
+    G4ThreeVector fCentre;
+    G4double fSize = 100.*CLHEP::nm;
+    G4double fSigma = 25.*CLHEP::nm;
+    G4double fDivergence = 0.;
+    G4int fRasterPoints = 10;
+
+    // derived from the parameters in Update()
+    G4bool fDirty = true;
+    G4double fHalfSize = 0.;
+    G4double fRasterPitch = 0.;
+    G4int fRasterCells = 1;
+};
+
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
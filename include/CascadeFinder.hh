@@ -0,0 +1,153 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file CascadeFinder.hh
+/// \brief Definition of the B1::CascadeFinder class
+
+#ifndef B1CascadeFinder_h
+#define B1CascadeFinder_h 1
+
+#include "TrackAncestry.hh"
+#include "G4Step.hh"
+#include "G4StepPoint.hh"
+#include "G4SystemOfUnits.hh"
+#include "globals.hh"
+
+#include <vector>
+
+class G4GenericMessenger;
+
+/// Groups the recoils of an event into damage cascades.
+///
+/// The vertex and the end point of every 12C recoil in the scoring volume
+/// are collected during the event. At its end the points are binned in a
+/// uniform hash grid with cells of the clustering radius, so that only the
+/// 27 cells around a point are searched for neighbours. Points closer than
+/// the radius are joined with union-find. One row per cluster is written
+/// to the Cascades ntuple: number of recoils and points, summed recoil
+/// energy, centroid and extent. The buffers keep their capacity from event
+/// to event, so the clustering does not allocate once they have grown.
+/// Commands are defined in the /b1/cascade/ directory.
+
+namespace B1
+{
+
+class OutputWriter;
+
+class CascadeFinder
+{
+  public:
+    CascadeFinder();
+    ~CascadeFinder();
+
+    // creates the Cascades ntuple, after the Mydata one
+    void Book(OutputWriter& output);
+
+    G4bool IsEnabled() const { return fEnabled; }
+    G4int GetNtupleId() const { return fNtupleId; }
+
+    struct Cluster
+    {
+      G4int recoils;
+      G4int points;
+      G4double energy;
+      G4double sum[3];
+      G4double min[3];
+      G4double max[3];
+    };
+
+    void SetRadius(G4double radius) { fRadius = radius; }
+
+    void BeginOfEvent() { fPoints.clear(); }
+    void Step(const G4Step* step, const TrackAncestry& ancestry);
+    void AddPoint(const G4ThreeVector& position, G4double energy, G4bool vertex);
+    // clusters the points added since BeginOfEvent(), in the order of their
+    // first point
+    const std::vector<Cluster>& FindClusters();
+    void EndOfEvent(G4int eventID, OutputWriter& output);
+
+  private:
+    struct Point
+    {
+      G4double x, y, z;
+      G4double energy;   // recoil energy at the vertex, 0 at the end point
+      G4bool vertex;
+    };
+    struct Cell
+    {
+      G4long ix, iy, iz;
+      G4int head;        // first point of the cell, -1 if the slot is free
+    };
+
+    void BuildGrid();
+    G4int FindSlot(G4long ix, G4long iy, G4long iz) const;
+    G4int FindRoot(G4int i);
+    void Join(G4int i, G4int j);
+    void DefineCommands();
+
+    G4GenericMessenger* fMessenger = nullptr;
+    G4bool fEnabled = false;
+    G4double fRadius = 5.*CLHEP::nm;
+    G4int fNtupleId = -1;
+
+    std::vector<Point> fPoints;
+    std::vector<Cell> fCells;
+    std::vector<G4int> fNext;        // next point of the same cell
+    std::vector<G4int> fParent;
+    std::vector<G4int> fSize;
+    std::vector<G4int> fClusterOf;   // cluster index of a root point
+    std::vector<Cluster> fClusters;
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+inline void CascadeFinder::Step(const G4Step* step, const TrackAncestry& ancestry)
+{
+  if (!fEnabled) return;
+
+  const G4Track* track = step->GetTrack();
+  if (ancestry.GetGeneration(track->GetTrackID()) <= 0
+      || track->GetDefinition()->GetParticleName() != "C12") return;
+
+  if (track->GetCurrentStepNumber() == 1) {
+    AddPoint(track->GetVertexPosition(), track->GetVertexKineticEnergy(), true);
+  }
+  if (step->GetPostStepPoint()->GetKineticEnergy() <= 0.) {
+    AddPoint(step->GetPostStepPoint()->GetPosition(), 0., false);
+  }
+}
+
+inline void CascadeFinder::AddPoint(const G4ThreeVector& position,
+                                    G4double energy, G4bool vertex)
+{
+  fPoints.push_back({ position.x(), position.y(), position.z(), energy, vertex });
+}
+
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
@@ -0,0 +1,121 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file Checkpoint.hh
+/// \brief Definition of the B1::Checkpoint class
+
+#ifndef B1Checkpoint_h
+#define B1Checkpoint_h 1
+
+#include "globals.hh"
+
+#include <chrono>
+#include <iosfwd>
+#include <string>
+
+class G4GenericMessenger;
+class G4Run;
+
+/// Periodic checkpoints of a long run and their resumption.
+///
+/// With /b1/checkpoint/everyEvents N or /b1/checkpoint/everyMinutes T a
+/// checkpoint is taken at the end of an event when N events have been done
+/// or T minutes have passed since the last one. A checkpoint
+///  - rotates the output file: the file is written and closed, renamed to
+///    <name>_seg<k>.<ext> and opened again; the csv row files of the
+///    asynchronous writer are written out and renamed with it, so that the
+///    ntuple rows of all events done so far are on disk,
+///  - writes the random engine state, the generator kinematics, the
+///    number of records of the phase-space recorder, the accumulables and
+///    the moments of the precision target (RunAction::Save()) and the H1
+///    contents (HistogramIO) to the checkpoint file; the file is written to <file>.tmp first and then
+///    renamed, so a killed job leaves either the previous or the new one.
+///
+/// /b1/checkpoint/resume <file> starts a run with the events left to the
+/// target of the interrupted run; the state is restored at its begin, so
+/// the results are identical to those of an uninterrupted run. The file is
+/// removed when a run with checkpoints reaches its target.
+///
+/// Checkpoints are taken in sequential mode only: in multi-threaded mode
+/// the workers process the events in no fixed order and reseed the engine
+/// per event, so the set of done events is not a prefix of the run.
+
+namespace B1
+{
+
+class RunAction;
+
+class Checkpoint
+{
+  public:
+    Checkpoint(RunAction* runAction);
+    ~Checkpoint();
+
+    void BeginOfRun(const G4Run* run);
+    void EndOfEvent();
+    void EndOfRun(const G4Run* run);
+
+    // a checkpoint is restored at the begin of the next run
+    G4bool IsResuming() const { return !fPending.empty(); }
+
+    // events of the interrupted run restored at the begin of this one
+    G4int GetResumedEvents() const { return fResumedEvents; }
+
+    // to be added to the event ID where the event sequence matters
+    static G4int GetEventOffset() { return fgEventOffset; }
+
+  private:
+    using Clock = std::chrono::steady_clock;
+
+    void Write();
+    void RotateOutput();
+    G4bool Restore(std::istream& in);
+    void Resume(const G4String& fileName);
+    void DefineCommands();
+
+    RunAction* fRunAction = nullptr;
+    G4GenericMessenger* fMessenger = nullptr;
+    G4int fEveryEvents = 0;
+    G4double fEveryMinutes = 0.;
+    G4String fFileName = "checkpoint.b1";
+
+    G4bool fActive = false;
+    G4int fEvents = 0;          // done towards the target, resumed included
+    G4int fTarget = 0;
+    G4int fSegment = 0;
+    G4int fLastEvents = 0;      // at the last checkpoint
+    Clock::time_point fLastTime;
+    G4int fResumedEvents = 0;
+    std::string fPending;       // checkpoint to restore at the next run
+
+    static G4int fgEventOffset;
+};
+
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
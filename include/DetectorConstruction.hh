@@ -31,12 +31,34 @@
 #define B1DetectorConstruction_h 1
 
 #include "G4VUserDetectorConstruction.hh"
+#include "G4ThreeVector.hh"
 #include "globals.hh"
 
+class G4GenericMessenger;
+class G4Material;
 class G4VPhysicalVolume;
 class G4LogicalVolume;
+class G4VTouchable;
 
 /// Detector construction class to define materials and geometry.
+///
+/// The envelope is the root of the region "EnvelopeRegion", to which the
+/// VacuumTransportModel is attached in every thread.
+///
+/// The diamond sample can be repeated in an array of samplesX x samplesY
+/// cells of the given pitch, built as two nested G4PVReplica (rows along y,
+/// cells along x), and divided into a stack of layers along z, a replica
+/// inside the sample. The scoring volume is then the layer, and every
+/// (layer, cell) has its own copy index for the scoring. The default 1x1
+/// array of one layer is the original single placement. The scoring volume
+/// carries the DiamondSD sensitive detector.
+///
+/// The sample material is diamond by default. It can be replaced by a NIST
+/// or an already defined material, given another density and doped with an
+/// element. After initialisation the material of the sample volumes is
+/// swapped in place and the physics is marked as modified; the geometry is
+/// not rebuilt, and at the next run only the tables of the new
+/// material-cuts couple are built. Commands are defined in /b1/det/.
 
 namespace B1
 {
@@ -48,11 +70,53 @@ class DetectorConstruction : public G4VUserDetectorConstruction
     ~DetectorConstruction() override;
 
     G4VPhysicalVolume* Construct() override;
+    void ConstructSDandField() override;
 
     G4LogicalVolume* GetScoringVolume() const { return fScoringVolume; }
 
+    // copies of the scoring volume and their total mass
+    G4int GetNofCopies() const
+    { return fNofSamplesX * fNofSamplesY * fNofLayers; }
+    G4double GetScoringMass() const;
+
+    // copy index, layer + layers * (x + samplesX * y), of a touchable in
+    // the scoring volume
+    G4int GetCopyIndex(const G4VTouchable* touchable) const;
+
+    // bounding box of all samples in global coordinates
+    const G4ThreeVector& GetSamplesMin() const { return fSamplesMin; }
+    const G4ThreeVector& GetSamplesMax() const { return fSamplesMax; }
+
   protected:
     G4LogicalVolume* fScoringVolume = nullptr;
+
+  private:
+    void SetSamplesX(G4int n);
+    void SetSamplesY(G4int n);
+    void SetPitch(G4double pitch);
+    void SetLayers(G4int n);
+    void SetMaterial(const G4String& name);
+    void SetDensity(G4double density);
+    void SetDopant(const G4String& symbol);
+    void SetDopantFraction(G4double fraction);
+    G4Material* BuildSampleMaterial();
+    void GeometryChanged();
+    void MaterialChanged();
+    void DefineCommands();
+
+    G4GenericMessenger* fMessenger = nullptr;
+    G4int fNofSamplesX = 1;
+    G4int fNofSamplesY = 1;
+    G4double fPitch;
+    G4int fNofLayers = 1;
+    G4ThreeVector fSamplesMin;
+    G4ThreeVector fSamplesMax;
+
+    G4String fMaterialName = "diamond";
+    G4double fDensity = 0.;          // 0: the density of the material
+    G4String fDopant = "none";
+    G4double fDopantFraction = 0.;   // mass fraction
+    G4LogicalVolume* fSampleVolume = nullptr;
 };
 
 }
@@ -0,0 +1,90 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file DiamondDepositHit.hh
+/// \brief Definition of the B1::DiamondDepositHit class
+
+#ifndef B1DiamondDepositHit_h
+#define B1DiamondDepositHit_h 1
+
+#include "G4Allocator.hh"
+#include "G4THitsCollection.hh"
+#include "G4VHit.hh"
+#include "globals.hh"
+
+/// Energy deposit of one copy of the scoring volume in one event.
+///
+/// DiamondSD keeps one hit per copy touched by the event and adds the
+/// deposit of every step to it. The hits come from a thread-local
+/// G4Allocator, whose pages are reused after the collection of the previous
+/// event is deleted.
+
+namespace B1
+{
+
+class DiamondDepositHit : public G4VHit
+{
+  public:
+    explicit DiamondDepositHit(G4int copy) : fCopy(copy) {}
+    ~DiamondDepositHit() override = default;
+
+    inline void* operator new(size_t);
+    inline void  operator delete(void*);
+
+    void AddEdep(G4double edep) { fEdep += edep; }
+
+    G4int GetCopy() const { return fCopy; }
+    G4double GetEdep() const { return fEdep; }
+
+  private:
+    G4int fCopy = 0;
+    G4double fEdep = 0.;
+};
+
+using DiamondDepositHitsCollection = G4THitsCollection<DiamondDepositHit>;
+
+extern G4ThreadLocal G4Allocator<DiamondDepositHit>* DiamondDepositHitAllocator;
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+inline void* DiamondDepositHit::operator new(size_t)
+{
+  if (!DiamondDepositHitAllocator) {
+    DiamondDepositHitAllocator = new G4Allocator<DiamondDepositHit>;
+  }
+  return (void*)DiamondDepositHitAllocator->MallocSingle();
+}
+
+inline void DiamondDepositHit::operator delete(void* hit)
+{
+  DiamondDepositHitAllocator->FreeSingle((DiamondDepositHit*)hit);
+}
+
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
@@ -0,0 +1,104 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file DiamondRecoilHit.hh
+/// \brief Definition of the B1::DiamondRecoilHit class
+
+#ifndef B1DiamondRecoilHit_h
+#define B1DiamondRecoilHit_h 1
+
+#include "G4Allocator.hh"
+#include "G4THitsCollection.hh"
+#include "G4ThreeVector.hh"
+#include "G4VHit.hh"
+#include "globals.hh"
+
+/// One C12 recoil (PKA or SKA) produced in the scoring volume.
+///
+/// DiamondSD records the hit at the first step of a C12 secondary, with its
+/// vertex position and kinetic energy, and updates its track length at
+/// every later step of the track in the scoring volume. The event action
+/// tells the PKA from the SKA by the generation of the parent and fills the
+/// recoil histograms and ntuple rows from the hits. The hits come from a
+/// thread-local G4Allocator, like the DiamondDepositHit.
+
+namespace B1
+{
+
+class DiamondRecoilHit : public G4VHit
+{
+  public:
+    DiamondRecoilHit(G4int trackID, G4int parentID, G4int copy,
+                     const G4ThreeVector& position, G4double energy)
+    : fTrackID(trackID), fParentID(parentID), fCopy(copy),
+      fPosition(position), fEnergy(energy) {}
+    ~DiamondRecoilHit() override = default;
+
+    inline void* operator new(size_t);
+    inline void  operator delete(void*);
+
+    G4int GetTrackID() const { return fTrackID; }
+    G4int GetParentID() const { return fParentID; }
+    G4int GetCopy() const { return fCopy; }
+    const G4ThreeVector& GetPosition() const { return fPosition; }
+    G4double GetEnergy() const { return fEnergy; }
+    // track length up to the last step in the scoring volume
+    void SetLength(G4double length) { fLength = length; }
+    G4double GetLength() const { return fLength; }
+
+  private:
+    G4int fTrackID = 0;
+    G4int fParentID = 0;
+    G4int fCopy = 0;
+    G4ThreeVector fPosition;
+    G4double fEnergy = 0.;
+    G4double fLength = 0.;
+};
+
+using DiamondRecoilHitsCollection = G4THitsCollection<DiamondRecoilHit>;
+
+extern G4ThreadLocal G4Allocator<DiamondRecoilHit>* DiamondRecoilHitAllocator;
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+inline void* DiamondRecoilHit::operator new(size_t)
+{
+  if (!DiamondRecoilHitAllocator) {
+    DiamondRecoilHitAllocator = new G4Allocator<DiamondRecoilHit>;
+  }
+  return (void*)DiamondRecoilHitAllocator->MallocSingle();
+}
+
+inline void DiamondRecoilHit::operator delete(void* hit)
+{
+  DiamondRecoilHitAllocator->FreeSingle((DiamondRecoilHit*)hit);
+}
+
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
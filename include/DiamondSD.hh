@@ -0,0 +1,87 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file DiamondSD.hh
+/// \brief Definition of the B1::DiamondSD class
+
+#ifndef B1DiamondSD_h
+#define B1DiamondSD_h 1
+
+#include "DiamondDepositHit.hh"
+#include "DiamondRecoilHit.hh"
+#include "G4VSensitiveDetector.hh"
+#include "globals.hh"
+
+#include <vector>
+
+class G4HCofThisEvent;
+class G4Step;
+class G4TouchableHistory;
+
+/// Sensitive detector of the scoring volume.
+///
+/// Two hits collections are filled during the event: "Deposits", one
+/// DiamondDepositHit per copy of the scoring volume that received energy,
+/// and "Recoils", one DiamondRecoilHit per C12 secondary, recorded at its
+/// first step; the later steps of the recoil update its track length (the
+/// kernel tracks the recoil to its end before the next track). Nothing else
+/// is done while tracking; the EventAction reads the collections at the end
+/// of the event.
+
+namespace B1
+{
+
+class DetectorConstruction;
+
+class DiamondSD : public G4VSensitiveDetector
+{
+  public:
+    DiamondSD(const G4String& name, const DetectorConstruction* detector);
+    ~DiamondSD() override = default;
+
+    void Initialize(G4HCofThisEvent* hce) override;
+    G4bool ProcessHits(G4Step* step, G4TouchableHistory* history) override;
+    void EndOfEvent(G4HCofThisEvent* hce) override;
+
+  private:
+    const DetectorConstruction* fDetector = nullptr;
+    DiamondDepositHitsCollection* fDepositHits = nullptr;
+    DiamondRecoilHitsCollection* fRecoilHits = nullptr;
+    G4int fDepositsID = -1;
+    G4int fRecoilsID = -1;
+
+    // index of the deposit hit of every copy in the event, -1 for none
+    std::vector<G4int> fCopyHit;
+    // the hit of the recoil being tracked
+    DiamondRecoilHit* fRecoilHit = nullptr;
+    G4int fRecoilTrackID = -1;
+};
+
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
@@ -0,0 +1,102 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file EdepAccumulable.hh
+/// \brief Definition of the B1::EdepAccumulable class
+
+#ifndef B1EdepAccumulable_h
+#define B1EdepAccumulable_h 1
+
+#include "G4VAccumulable.hh"
+#include "G4SystemOfUnits.hh"
+#include "globals.hh"
+
+#include <iosfwd>
+#include <vector>
+
+/// Accumulable of the per-event energy deposit.
+///
+/// Every event adds one value. The moments are kept with Welford's update
+/// (count, mean and sum of squared deviations), which does not lose the
+/// variance to cancellation like the sum of squares does. The distribution
+/// is kept in a quantile sketch with logarithmic buckets: a value x > 0
+/// goes to bucket i = ceil(log_gamma(x)), gamma = (1+a)/(1-a), so that any
+/// quantile is returned within the relative accuracy a. Both parts merge
+/// exactly by addition, so each thread fills its own copy without locks
+/// and the copies are combined by the accumulable manager at end of run.
+
+namespace B1
+{
+
+class EdepAccumulable : public G4VAccumulable
+{
+  public:
+    EdepAccumulable(const G4String& name, G4double relativeAccuracy = 0.01,
+                    G4double minValue = 1.*CLHEP::eV);
+    ~EdepAccumulable() override = default;
+
+    void Fill(G4double value);
+
+    void Merge(const G4VAccumulable& other) override;
+    void Reset() override;
+
+    // text form of the complete state, for the checkpoints
+    void Save(std::ostream& out) const;
+    G4bool Restore(std::istream& in);
+
+    G4double GetCount() const { return fCount; }
+    G4double GetMean() const { return fMean; }
+    G4double GetSumSquaredDeviations() const { return fM2; }
+    G4double GetVariance() const;
+    G4double GetMin() const { return fMin; }
+    G4double GetMax() const { return fMax; }
+
+    // q in [0, 1]; values below the minimum value are returned as 0
+    G4double GetQuantile(G4double q) const;
+
+  private:
+    G4int BucketIndex(G4double value) const;
+
+    G4double fGamma;
+    G4double fLogGamma;
+    G4double fMinValue;
+
+    G4double fCount = 0.;
+    G4double fMean = 0.;
+    G4double fM2 = 0.;
+    G4double fMin = 0.;
+    G4double fMax = 0.;
+
+    G4double fLowCount = 0.;        // values below fMinValue
+    G4int fOffset = 0;              // bucket index of fBuckets[0]
+    std::vector<G4double> fBuckets;
+};
+
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
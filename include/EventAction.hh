@@ -30,11 +30,27 @@
 #ifndef B1EventAction_h
 #define B1EventAction_h 1
 
+#include "TrackAncestry.hh"
 #include "G4UserEventAction.hh"
 #include "globals.hh"
 
+class G4GenericMessenger;
+class G4HCofThisEvent;
+
 /// Event action class
 ///
+/// At the end of the event the hits collections of the DiamondSD are read in
+/// one pass: the deposit hits give the total energy deposit and fill the
+/// per-copy energy histogram; every recoil hit fills the per-copy recoil
+/// count, the PKA or SKA energy and length histograms, the position maps
+/// and one recoil row of Mydata.
+/// An event with neither is counted as empty in the RunAction; in sparse
+/// mode (/b1/output/sparseEvents) it adds no event row. The ancestry of the
+/// tracks of the event is kept here as well.
+///
+/// /b1/event/verbose prints the energy deposit of every event (1) and also
+/// the positions and recoils of every step in the scoring volume (2); the
+/// default 0 prints nothing per event.
 
 namespace B1
 {
@@ -52,9 +68,23 @@ class EventAction : public G4UserEventAction
 
     void AddEdep(G4double edep) { fEdep += edep; }
 
+    RunAction* GetRunAction() const { return fRunAction; }
+    TrackAncestry& GetAncestry() { return fAncestry; }
+    const TrackAncestry& GetAncestry() const { return fAncestry; }
+    G4int GetVerboseLevel() const { return fVerbose; }
+
   private:
+    void ProcessHits(G4HCofThisEvent* hce);
+    void DefineCommands();
+
+    G4GenericMessenger* fMessenger = nullptr;
     RunAction* fRunAction = nullptr;
     G4double   fEdep = 0.;
+    G4int fRecoils = 0;
+    G4int fDepositsID = -1;
+    G4int fRecoilsID = -1;
+    TrackAncestry fAncestry;
+    G4int fVerbose = 0;
 };
 
 }
@@ -0,0 +1,91 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file HistogramIO.hh
+/// \brief Definition of the B1::HistogramIO class
+
+#ifndef B1HistogramIO_h
+#define B1HistogramIO_h 1
+
+#include "globals.hh"
+
+#include <iosfwd>
+#include <vector>
+
+/// Text serialization of the analysis manager 1D histograms.
+///
+/// For every H1 the axis (number of bins and range) and the full per-bin
+/// sums of the tools histogram are written, under- and overflow included:
+/// entries, sum of weights, of squared weights, of x*w and of x*x*w. Read()
+/// checks the axis against the booked histogram and restores the bins with
+/// set_bin_content(), so that the histogram continues exactly as if it had
+/// never been written. Doubles are written with 17 significant digits,
+/// which round-trips them.
+///
+/// H1Bins is a copy of the bins of one histogram that can be taken on the
+/// filling thread and summed with the copies of other threads.
+
+namespace B1
+{
+
+class HistogramIO
+{
+  public:
+    struct H1Bins
+    {
+      G4int id = -1;
+      G4int nbins = 0;                  // of the axis, 0 if not booked
+      G4double lower = 0.;
+      G4double upper = 0.;
+      // per bin, under- and overflow included
+      std::vector<unsigned int> entries;
+      std::vector<G4double> sumW;
+      std::vector<G4double> sumW2;
+      std::vector<G4double> sumXW;
+      std::vector<G4double> sumX2W;
+
+      // false if the binnings differ
+      G4bool Add(const H1Bins& other);
+    };
+
+    static H1Bins GetH1(G4int id);
+    static G4bool SetH1(const H1Bins& bins);
+    static void Write(std::ostream& out, const H1Bins& bins);
+    static G4bool Read(std::istream& in, H1Bins& bins);
+
+    static void WriteH1(std::ostream& out, G4int id);
+    static G4bool ReadH1(std::istream& in, G4int id);
+
+    // all booked H1s, preceded by their number
+    static void WriteAll(std::ostream& out);
+    static G4bool ReadAll(std::istream& in);
+};
+
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
@@ -0,0 +1,133 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file HistogramSet.hh
+/// \brief Definition of the B1::HistogramSet class
+
+#ifndef B1HistogramSet_h
+#define B1HistogramSet_h 1
+
+#include "LogHistogram.hh"
+#include "globals.hh"
+
+#include <iosfwd>
+#include <memory>
+#include <vector>
+
+class G4GenericMessenger;
+
+/// The 1D histograms of the example and their binning.
+///
+/// Book() creates the H1s in the order of their ids. The binning is chosen
+/// per run with /b1/histo/mode:
+///  - fixed: the original linear ranges,
+///  - log:   logarithmic bins over a wide fixed range (/b1/histo/binsPerDecade),
+///  - auto:  the fills go to LogHistogram accumulables whose range follows
+///           the data; at the end of the run the master redefines each H1
+///           with the merged bin edges and fills it with the bin contents.
+/// In every mode all threads book the same binning at the begin of the run,
+/// so that the worker histograms can be merged into the master ones.
+///
+/// Two more H1s have one bin per copy of the scoring volume (see
+/// DetectorConstruction::GetCopyIndex()): the energy deposit and the number
+/// of recoils per copy, filled with weights. Their binning follows the
+/// geometry of the run, whatever the mode.
+///
+/// The spatial histograms cover the bounding box of the samples of the run:
+/// the depth of the PKA vertices below the front face (H1), the recoil
+/// positions in the x-y and x-z planes (H2) and in 3D (H3). They need no
+/// ntuple and make up the output of the histogram-only mode
+/// (/b1/output/ntuples false).
+
+namespace B1
+{
+
+class DetectorConstruction;
+class OutputWriter;
+
+class HistogramSet
+{
+  public:
+    HistogramSet();
+    ~HistogramSet();
+
+    void Book();
+    void BeginOfRun(OutputWriter& output, const DetectorConstruction& detector);
+    void EndOfRun(G4bool isMaster);
+
+    G4int GetCopyEdepId() const { return fCopyEdepId; }
+    G4int GetCopyRecoilsId() const { return fCopyRecoilsId; }
+    G4int GetPkaDepthId() const { return fPkaDepthId; }
+    G4int GetMapXYId() const { return fMapXYId; }
+    G4int GetMapXZId() const { return fMapXZId; }
+    G4int GetMapXYZId() const { return fMapXYZId; }
+    // z of the front face of the samples, for the depth
+    G4double GetFrontZ() const { return fFrontZ; }
+
+    // the LogHistogram accumulables filled in auto mode, empty otherwise
+    std::vector<const LogHistogram*> GetAutoHistograms() const;
+
+    // state of the LogHistogram accumulables, for the checkpoints
+    void Save(std::ostream& out) const;
+    G4bool Restore(std::istream& in);
+
+  private:
+    struct Spec
+    {
+      G4String name;
+      G4String title;
+      G4int nbins;
+      G4double min;
+      G4double max;
+      G4double logMin;    // range in log mode
+      G4double logMax;
+    };
+
+    void DefineCommands();
+
+    G4GenericMessenger* fMessenger = nullptr;
+    G4String fMode = "fixed";
+    G4double fBinsPerDecade = 20.;
+    G4int fMaxBins = 400;
+    G4int fMapBins = 100;
+    G4int fMapBins3D = 20;
+
+    std::vector<Spec> fSpecs;
+    G4int fCopyEdepId = -1;
+    G4int fCopyRecoilsId = -1;
+    G4int fPkaDepthId = -1;
+    G4int fMapXYId = -1;
+    G4int fMapXZId = -1;
+    G4int fMapXYZId = -1;
+    G4double fFrontZ = 0.;
+    std::vector<std::unique_ptr<LogHistogram>> fAutoHistograms;
+};
+
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
@@ -0,0 +1,99 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file LogHistogram.hh
+/// \brief Definition of the B1::LogHistogram class
+
+#ifndef B1LogHistogram_h
+#define B1LogHistogram_h 1
+
+#include "G4VAccumulable.hh"
+#include "globals.hh"
+
+#include <iosfwd>
+#include <vector>
+
+/// Accumulable histogram on a global logarithmic grid.
+///
+/// Bin i covers [10^(i*w), 10^((i+1)*w)) with the width w = 2^level/b in
+/// decades, b being the configured bins per decade. Only the bins between
+/// the smallest and the largest filled one are stored, so the range follows
+/// the data. When more than the maximum number of bins would be needed, the
+/// grid is coarsened by merging pairs of bins (level + 1); this is exact
+/// since the coarse bins are unions of fine ones. Two histograms merge by
+/// coarsening the finer one to the level of the other and adding the bins.
+/// Values <= 0 are counted in the underflow.
+
+namespace B1
+{
+
+class LogHistogram : public G4VAccumulable
+{
+  public:
+    LogHistogram(const G4String& name, G4double binsPerDecade = 20.,
+                 G4int maxBins = 400);
+    ~LogHistogram() override = default;
+
+    // takes effect at the next Reset()
+    void Configure(G4double binsPerDecade, G4int maxBins);
+
+    void Fill(G4double value, G4double weight = 1.);
+
+    void Merge(const G4VAccumulable& other) override;
+    void Reset() override;
+
+    // text form of the complete state, for the checkpoints
+    void Save(std::ostream& out) const;
+    G4bool Restore(std::istream& in);
+
+    G4double GetEntries() const;
+    G4double GetUnderflow() const { return fUnderflow; }
+    G4int GetNbins() const { return G4int(fContents.size()); }
+    G4double GetBinContent(G4int bin) const { return fContents[bin]; }
+    std::vector<G4double> GetEdges() const;
+
+  private:
+    G4double BinWidth() const;   // in decades
+    G4int Index(G4double value) const;
+    void Add(G4int offset, const std::vector<G4double>& contents);
+    void Coarsen();
+
+    G4double fBinsPerDecade;
+    G4int fMaxBins;
+    G4double fNextBinsPerDecade;
+    G4int fNextMaxBins;
+
+    G4int fLevel = 0;
+    G4double fUnderflow = 0.;
+    G4int fOffset = 0;              // grid index of fContents[0]
+    std::vector<G4double> fContents;
+};
+
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
@@ -0,0 +1,293 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file OutputWriter.hh
+/// \brief Definition of the B1::OutputWriter class
+
+#ifndef B1OutputWriter_h
+#define B1OutputWriter_h 1
+
+#include "LogHistogram.hh"
+#include "SpscQueue.hh"
+#include "G4AnalysisManager.hh"
+#include "globals.hh"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class G4GenericMessenger;
+
+/// Output path of the user actions.
+///
+/// The actions fill histograms and ntuple columns through this class. All
+/// calls to the analysis manager are made on the thread that owns it: the
+/// histograms are always filled directly, and in the default synchronous
+/// mode the ntuple rows go straight to the manager as well.
+///
+/// In asynchronous mode (/b1/output/async) the ntuple rows never reach the
+/// analysis manager. The tracking thread copies the column values of each
+/// row into a block of /b1/output/batchSize rows and hands full blocks to a
+/// writer thread through a lock-free queue. The writer formats the rows and
+/// writes them to one csv file per ntuple, <file>_nt_<ntuple>[_t<thread>].csv,
+/// so that neither formatting nor disk I/O of the rows runs on the tracking
+/// thread. The writer never touches the analysis manager. A fixed pool of
+/// blocks, /b1/output/queueSize rows in total, bounds the memory; when all
+/// blocks are in flight the producer waits (backpressure, counted as
+/// stalls). The writer is started once and lives as long as this object;
+/// between blocks it sleeps on a condition variable. At the end of a run
+/// the last block and a close request are queued without waiting for the
+/// disk, so the csv files are complete once the next run has started or
+/// the program has ended. Flush() and RotateRows() wait for the writer;
+/// they are meant for checkpoints.
+///
+/// The ntuples are booked through this class (CreateNtuple() and the
+/// column calls), which forwards the booking to the analysis manager and
+/// keeps the column layout the writer needs. In asynchronous mode the
+/// analysis manager ntuples are deactivated, so its file holds the
+/// histograms only.
+///
+/// An H1 can be redirected to a LogHistogram accumulable (SetH1Sink()), which
+/// is then filled instead of the analysis manager histogram.
+///
+/// The ntuple calls without an ntuple id fill the first ntuple (Mydata).
+///
+/// The output file is opened in BeginOfRun() and written in WriteFile(),
+/// with the format, name, basket and compression settings of the
+/// /b1/output/ commands. With the format "none" no file is opened and the
+/// ntuple calls are dropped; the histograms are still filled in memory.
+/// With /b1/output/ntuples false the ntuples are deactivated and their calls
+/// dropped as well, but the histograms are written to the file.
+///
+/// With /b1/output/sparseEvents the EventAction adds the event row of the
+/// first ntuple only for events with an energy deposit or a recoil; the
+/// number of the skipped empty events is printed at the end of the run.
+///
+/// In multi-threaded mode the worker ntuples are merged into the master
+/// file by default. With /b1/output/mergeNtuples false every worker writes
+/// its ntuples to its own file, <file>_t<thread>.<ext>, and the master
+/// writes the histograms and a manifest, <file>.manifest, listing all files
+/// of the run; analysis/merge_output.py merges them or lists them for a
+/// chain. The csv files of the asynchronous mode are always per thread and
+/// listed in the manifest.
+
+namespace B1
+{
+
+class OutputWriter
+{
+  public:
+    OutputWriter();
+    ~OutputWriter();
+
+    // booking, forwarded to the analysis manager; returns the ntuple id
+    G4int CreateNtuple(const G4String& name, const G4String& title);
+    G4int CreateNtupleDColumn(const G4String& name);
+    G4int CreateNtupleIColumn(const G4String& name);
+    void FinishNtuple();
+
+    // opens the file
+    void BeginOfRun();
+    // in asynchronous mode, opens the csv files of the writer thread
+    void StartWriter();
+    // queues the last rows; does not wait for the writer
+    void EndOfRun();
+
+    // writes and closes the output file, after EndOfRun()
+    void WriteFile();
+
+    // wait until the writer has written all rows queued so far; RotateRows()
+    // then renames the csv files to <name>_seg<segment>.csv and starts new
+    // ones
+    void Flush();
+    void RotateRows(G4int segment);
+
+    // nullptr restores the filling of the analysis manager histogram
+    void SetH1Sink(G4int id, LogHistogram* sink);
+
+    G4bool IsSparseEvents() const { return fSparseEvents; }
+
+    void FillH1(G4int id, G4double value, G4double weight = 1.);
+    void FillH2(G4int id, G4double x, G4double y, G4double weight = 1.);
+    void FillH3(G4int id, G4double x, G4double y, G4double z,
+                G4double weight = 1.);
+    void FillNtupleDColumn(G4int column, G4double value);
+    void FillNtupleIColumn(G4int column, G4int value);
+    void AddNtupleRow();
+
+    void FillNtupleDColumn(G4int ntupleId, G4int column, G4double value);
+    void FillNtupleIColumn(G4int ntupleId, G4int column, G4int value);
+    void AddNtupleRow(G4int ntupleId);
+
+  private:
+    struct Ntuple
+    {
+      G4String name;
+      G4String title;
+      std::vector<G4String> columns;
+      std::vector<G4bool> isInt;
+      std::vector<G4double> row;  // the values of the row being filled
+    };
+
+    // rows of the asynchronous mode, or a request to the writer
+    struct Block
+    {
+      enum Kind : G4int { kRows, kOpen, kClose, kFlush, kRotate };
+      Kind kind = kRows;
+      G4int segment = 0;
+      std::vector<G4int> ntuples;    // ntuple index of each row
+      std::vector<G4double> values;  // the columns of all rows, in order
+    };
+
+    LogHistogram* H1Sink(G4int id) const;
+    void AddRow(std::size_t index);
+    Block* TakeBlock();
+    void Send(Block* block);
+    void SendRequest(Block::Kind kind, G4int segment = 0);
+    void WaitForWriter();
+    void StopWriter();
+    void WriterLoop();
+    void WriteBlock(const Block& block);
+    void OpenRowFiles();
+    void CloseRowFiles();
+    G4String RowFileName(const Ntuple& ntuple) const;
+    void OpenFile();
+    G4String DiskFileName() const;
+    void WriteManifest() const;
+    void DefineCommands();
+
+    G4GenericMessenger* fMessenger = nullptr;
+    G4bool fAsync = false;
+    G4int fQueueSize = 1 << 16;
+    G4int fBatchSize = 1024;
+    G4String fFormat = "root";
+    G4String fFileName = "Mydata";
+    G4int fBasketSize = 0;       // 0: the analysis manager default
+    G4int fBasketEntries = 0;
+    G4int fCompression = -1;     // -1: the analysis manager default
+    G4bool fNtuples = true;
+    G4bool fMergeNtuples = true;
+    G4bool fSparseEvents = false;
+    G4int fMergeApplied = -1;    // set at the first file, -1 before
+    G4bool fNtuplesOff = false;
+
+    G4AnalysisManager* fAnalysisManager = nullptr;
+    std::vector<LogHistogram*> fH1Sinks;
+    std::vector<Ntuple> fNtupleBook;
+    G4int fFirstNtupleId = 0;
+
+    // asynchronous mode; the row files belong to the writer thread
+    G4bool fRunning = false;     // rows go to the writer in this run
+    std::vector<Block> fBlocks;
+    std::unique_ptr<SpscQueue<Block*>> fFull;   // to the writer
+    std::unique_ptr<SpscQueue<Block*>> fFree;   // back from the writer
+    Block* fCurrent = nullptr;
+    std::size_t fRowsPerBlock = 0;
+    std::vector<G4String> fRowFileNames;
+    std::vector<std::FILE*> fRowFiles;
+    std::thread fWriter;
+    std::mutex fMutex;
+    std::condition_variable fWake;     // a block is queued or fQuit is set
+    std::condition_variable fDone;     // fAcknowledged changed
+    G4bool fQuit = false;
+    G4long fRequested = 0;             // flush and rotate requests sent
+    G4long fAcknowledged = 0;          // and carried out by the writer
+    std::atomic<G4int> fWriteErrors{0};
+    G4long fStalls = 0;
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+inline LogHistogram* OutputWriter::H1Sink(G4int id) const
+{
+  return (id < G4int(fH1Sinks.size())) ? fH1Sinks[id] : nullptr;
+}
+
+inline void OutputWriter::FillH1(G4int id, G4double value, G4double weight)
+{
+  if (auto sink = H1Sink(id)) sink->Fill(value, weight);
+  else fAnalysisManager->FillH1(id, value, weight);
+}
+
+inline void OutputWriter::FillH2(G4int id, G4double x, G4double y,
+                                 G4double weight)
+{
+  fAnalysisManager->FillH2(id, x, y, weight);
+}
+
+inline void OutputWriter::FillH3(G4int id, G4double x, G4double y, G4double z,
+                                 G4double weight)
+{
+  fAnalysisManager->FillH3(id, x, y, z, weight);
+}
+
+inline void OutputWriter::FillNtupleDColumn(G4int column, G4double value)
+{
+  FillNtupleDColumn(fFirstNtupleId, column, value);
+}
+
+inline void OutputWriter::FillNtupleDColumn(G4int ntupleId, G4int column,
+                                            G4double value)
+{
+  if (fNtuplesOff) return;
+  if (fRunning) fNtupleBook[ntupleId - fFirstNtupleId].row[column] = value;
+  else fAnalysisManager->FillNtupleDColumn(ntupleId, column, value);
+}
+
+inline void OutputWriter::FillNtupleIColumn(G4int column, G4int value)
+{
+  FillNtupleIColumn(fFirstNtupleId, column, value);
+}
+
+inline void OutputWriter::FillNtupleIColumn(G4int ntupleId, G4int column,
+                                            G4int value)
+{
+  if (fNtuplesOff) return;
+  if (fRunning) fNtupleBook[ntupleId - fFirstNtupleId].row[column] = value;
+  else fAnalysisManager->FillNtupleIColumn(ntupleId, column, value);
+}
+
+inline void OutputWriter::AddNtupleRow()
+{
+  AddNtupleRow(fFirstNtupleId);
+}
+
+inline void OutputWriter::AddNtupleRow(G4int ntupleId)
+{
+  if (fNtuplesOff) return;
+  if (fRunning) AddRow(ntupleId - fFirstNtupleId);
+  else fAnalysisManager->AddNtupleRow(ntupleId);
+}
+
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
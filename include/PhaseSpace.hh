@@ -0,0 +1,102 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file PhaseSpace.hh
+/// \brief Definition of the phase-space file format and reader
+
+#ifndef B1PhaseSpace_h
+#define B1PhaseSpace_h 1
+
+#include "globals.hh"
+
+#include <cstdint>
+#include <memory>
+
+/// Binary phase-space file: a 32-byte header followed by fixed 36-byte
+/// records in the byte order of the writing machine.
+///
+/// Positions are in mm, energies in MeV, the direction is a unit vector.
+/// Ions are stored with their PDG code 100ZZZAAAI.
+
+namespace B1
+{
+
+struct PhaseSpaceHeader
+{
+  char magic[8];              // "B1PHSP1\0"
+  std::uint32_t recordSize;   // sizeof(PhaseSpaceRecord)
+  std::uint32_t flags;        // reserved, 0
+  std::uint64_t nofRecords;
+  std::uint64_t reserved;
+};
+
+struct PhaseSpaceRecord
+{
+  std::int32_t pdg;
+  float energy;
+  float x, y, z;
+  float dx, dy, dz;
+  float weight;
+};
+
+static_assert(sizeof(PhaseSpaceHeader) == 32, "phase-space header layout");
+static_assert(sizeof(PhaseSpaceRecord) == 36, "phase-space record layout");
+
+extern const char kPhaseSpaceMagic[8];
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+/// Read-only memory mapping of a phase-space file.
+///
+/// Open() maps every file once per process; the threads share the mapping
+/// and read their records from it without locking or copying.
+
+class PhaseSpaceReader
+{
+  public:
+    ~PhaseSpaceReader();
+
+    static std::shared_ptr<const PhaseSpaceReader> Open(const G4String& fileName);
+
+    const G4String& GetFileName() const { return fFileName; }
+    std::uint64_t GetSize() const { return fNofRecords; }
+    const PhaseSpaceRecord& operator[](std::uint64_t i) const { return fRecords[i]; }
+
+  private:
+    PhaseSpaceReader(const G4String& fileName);
+
+    G4String fFileName;
+    void* fMapping = nullptr;
+    std::size_t fMappingSize = 0;
+    const PhaseSpaceRecord* fRecords = nullptr;
+    std::uint64_t fNofRecords = 0;
+};
+
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
@@ -0,0 +1,113 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file PhaseSpaceRecorder.hh
+/// \brief Definition of the B1::PhaseSpaceRecorder class
+
+#ifndef B1PhaseSpaceRecorder_h
+#define B1PhaseSpaceRecorder_h 1
+
+#include "PhaseSpace.hh"
+#include "G4Step.hh"
+#include "G4StepPoint.hh"
+#include "globals.hh"
+
+#include <cstdio>
+#include <vector>
+
+class G4GenericMessenger;
+
+/// Writes the particles crossing the plane z = const in +z direction to a
+/// phase-space file (see PhaseSpace.hh), to be replayed with
+/// /b1/gun/source phaseSpace.
+///
+/// Every thread writes its own part file through a record buffer; at the end
+/// of the run the master concatenates the parts in the output file and
+/// removes them. Optionally the recorded tracks are killed, so that the
+/// upstream run does not transport them further.
+///
+/// A checkpoint (see Checkpoint) saves the number of records written to the
+/// part file with Sync(). A resumed run keeps the part file, cuts it back to
+/// that number with Restore() and appends to it, so the merged file holds
+/// the records of all events, as in an uninterrupted run.
+
+namespace B1
+{
+
+class PhaseSpaceRecorder
+{
+  public:
+    PhaseSpaceRecorder();
+    ~PhaseSpaceRecorder();
+
+    G4bool IsEnabled() const { return fEnabled; }
+
+    // a resumed run keeps the part file, see Restore()
+    void BeginOfRun(G4bool resuming = false);
+    void EndOfRun(G4bool isMaster);
+
+    // checkpoint state: Sync() writes the buffered records out and returns
+    // the number in the part file; Restore() cuts the part file back to it
+    G4bool IsRecording() const { return fPart != nullptr; }
+    std::uint64_t Sync();
+    G4bool Restore(G4bool recording, std::uint64_t nofRecords);
+
+    void Step(const G4Step* step);
+
+  private:
+    void Record(const G4Step* step);
+    void Flush();
+    void Merge();
+    void DefineCommands();
+
+    G4GenericMessenger* fMessenger = nullptr;
+    G4bool fEnabled = false;
+    G4String fFileName = "phasespace.phsp";
+    G4double fPlaneZ = 0.;
+    G4bool fKill = false;
+
+    std::FILE* fPart = nullptr;
+    G4String fPartName;
+    std::vector<PhaseSpaceRecord> fBuffer;
+    std::uint64_t fNofRecords = 0;
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+inline void PhaseSpaceRecorder::Step(const G4Step* step)
+{
+  if (!fPart) return;
+  if (step->GetPreStepPoint()->GetPosition().z() < fPlaneZ
+      && step->GetPostStepPoint()->GetPosition().z() >= fPlaneZ) {
+    Record(step);
+  }
+}
+
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
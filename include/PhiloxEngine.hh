@@ -0,0 +1,96 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file PhiloxEngine.hh
+/// \brief Definition of the B1::PhiloxEngine class
+
+#ifndef B1PhiloxEngine_h
+#define B1PhiloxEngine_h 1
+
+#include "CLHEP/Random/RandomEngine.h"
+
+#include <array>
+#include <cstdint>
+
+/// Counter-based random engine, Philox4x32-10 (Salmon et al., SC11).
+///
+/// The state is a 128-bit counter and a 64-bit key taken from the seeds;
+/// block n of the stream is the keyed bijection of the counter value n, so
+/// blocks are independent of each other and flatArray() fills its output
+/// in a loop without a dependency chain between iterations. Every block
+/// gives two doubles with 53 random bits each.
+
+namespace B1
+{
+
+class PhiloxEngine : public CLHEP::HepRandomEngine
+{
+  public:
+    PhiloxEngine();
+    explicit PhiloxEngine(long seed);
+    ~PhiloxEngine() override = default;
+
+    double flat() override;
+    void flatArray(const int size, double* vect) override;
+
+    void setSeed(long seed, int dummy = 0) override;
+    void setSeeds(const long* seeds, int dummy = 0) override;
+
+    void saveStatus(const char filename[] = "Philox.conf") const override;
+    void restoreStatus(const char filename[] = "Philox.conf") override;
+    void showStatus() const override;
+
+    std::ostream& put(std::ostream& os) const override;
+    std::istream& get(std::istream& is) override;
+    std::istream& getState(std::istream& is) override;
+    std::vector<unsigned long> put() const override;
+    bool get(const std::vector<unsigned long>& v) override;
+    bool getState(const std::vector<unsigned long>& v) override;
+
+    std::string name() const override { return "PhiloxEngine"; }
+    static std::string engineName() { return "PhiloxEngine"; }
+
+    // the bijection itself, checked by test/philox_kat.cc
+    using Block = std::array<std::uint32_t, 4>;
+    static Block Generate(const Block& counter, std::uint32_t key0,
+                          std::uint32_t key1);
+
+  private:
+    static double ToDouble(std::uint32_t hi, std::uint32_t lo);
+    void Increment();
+
+    Block fCounter = { 0, 0, 0, 0 };
+    std::uint32_t fKey0 = 0;
+    std::uint32_t fKey1 = 0;
+    Block fOutput = { 0, 0, 0, 0 };
+    int fUsed = 2;    // doubles of fOutput already returned
+};
+
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
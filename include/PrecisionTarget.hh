@@ -0,0 +1,110 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file PrecisionTarget.hh
+/// \brief Definition of the B1::PrecisionTarget class
+
+#ifndef B1PrecisionTarget_h
+#define B1PrecisionTarget_h 1
+
+#include "globals.hh"
+
+#include <iosfwd>
+
+class G4GenericMessenger;
+
+/// Stops a run when an observable reaches a target relative uncertainty.
+///
+/// With /b1/run/precision r > 0 the run is aborted, after the current
+/// events, once the relative standard error of the chosen observable
+/// (/b1/run/observable) is at most r:
+///  - dose:          the summed energy deposit in the scoring volume,
+///  - pkaCount:      the number of primary knock-on atoms,
+///  - pkaMeanEnergy: the mean kinetic energy of the PKAs.
+/// Every thread keeps the moments of its current batch of events and adds
+/// them to the shared totals under a lock every /b1/run/checkInterval
+/// events; the thread that finds the target reached sets a shared flag,
+/// and every thread aborts its event loop when it sees the flag. The
+/// number of /run/beamOn is the hard cap.
+///
+/// Save() and Restore() carry the totals and the current batch over a
+/// checkpoint (sequential mode), so a resumed run stops at the same event
+/// as an uninterrupted one.
+
+namespace B1
+{
+
+class PrecisionTarget
+{
+  public:
+    PrecisionTarget();
+    ~PrecisionTarget();
+
+    void BeginOfRun(G4bool isMaster);
+    void CountPka(G4double energy);
+    void EndOfEvent(G4double edep);
+    void EndOfRun(G4bool isMaster);
+
+    // after BeginOfRun(); the thread must be the only one of the run
+    void Save(std::ostream& out) const;
+    G4bool Restore(std::istream& in);
+
+    // Welford moments, merged with Chan's formula
+    struct Moments
+    {
+      G4double n = 0.;
+      G4double mean = 0.;
+      G4double m2 = 0.;
+
+      void Add(G4double value);
+      void Merge(const Moments& other);
+      // standard error of the sum (or of the mean) relative to it
+      G4double RelativeError() const;
+    };
+
+  private:
+    void Check();
+    void DefineCommands();
+
+    G4GenericMessenger* fMessenger = nullptr;
+    G4double fPrecision = 0.;
+    G4String fObservable = "dose";
+    G4int fCheckInterval = 1000;
+    G4int fMinEvents = 100;
+
+    G4bool fActive = false;
+    G4bool fAborted = false;
+    G4int fEventPkas = 0;
+    Moments fEdep;          // per event
+    Moments fPkaCount;      // per event
+    Moments fPkaEnergy;     // per PKA
+};
+
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
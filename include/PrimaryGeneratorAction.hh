@@ -32,16 +32,38 @@
 
 #include "G4VUserPrimaryGeneratorAction.hh"
 #include "G4ParticleGun.hh"
+#include "BeamProfile.hh"
+#include "PhaseSpace.hh"
+#include "RandomBatch.hh"
 #include "globals.hh"
 
+#include <iosfwd>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+class G4GenericMessenger;
 class G4ParticleGun;
 class G4Event;
-class G4Box;
 
 /// The primary generator action class with particle gun.
 ///
-/// The default kinematic is a 6 MeV gamma, randomly distribued
-/// in front of the phantom across 80% of the (X,Y) phantom size.
+/// The default kinematic is a 24 GeV proton along +z, uniformly distributed
+/// over a 100 nm square at z = 0; the spot and divergence are set by the
+/// BeamProfile commands (/b1/gun/profile ...).
+///
+/// The uniform random numbers are taken from a per-thread RandomBatch. With
+/// /b1/gun/spectrum the energy of every primary is sampled from the fast
+/// neutron spectrum, either by the original rejection loop or from a
+/// tabulated inverse CDF (one random number per primary).
+///
+/// With /b1/gun/source phaseSpace the primaries are instead read from a
+/// memory-mapped phase-space file. Each thread reads its own contiguous
+/// share of the records front to back, /b1/gun/phaseSpaceParticles records
+/// per event, and starts again at the beginning of its share when it is
+/// used up.
+///
+/// /b1/gun/verbose 1 prints the energy and position of every primary.
 
 namespace B1
 {
@@ -61,10 +83,43 @@ class PrimaryGeneratorAction : public G4VUserPrimaryGeneratorAction
     std::vector<G4double> GetPrimaryEnergies() const;
     G4double GetPrimaryEnergy() const;
 
+    // fast neutron energy spectrum sampling
+    G4double GetEnergyFromSpectrum();
+    G4double GetEnergyFromTable();
+
+    // gun kinematics carried from event to event and the phase-space
+    // position, for the checkpoints
+    void Save(std::ostream& out) const;
+    G4bool Restore(std::istream& in);
+
   private:
+    static G4double SpectrumDensity(G4double energy);  // energy in MeV
+    void BuildSpectrumTable();
+    G4double SampleEnergy();
+    void OpenPhaseSpace();
+    void GeneratePhaseSpace(G4Event* event);
+    const G4ParticleDefinition* FindParticle(G4int pdg);
+    void DefineCommands();
+
+    G4GenericMessenger* fMessenger = nullptr;
+    G4String fSpectrumMode = "off";
+    G4int fVerbose = 0;
+    RandomBatch fRandom;
+    std::vector<G4double> fSpectrumEnergies;   // grid of the inverse CDF
+    std::vector<G4double> fSpectrumCdf;
+
+    G4String fSource = "gun";
+    G4String fPhaseSpaceFile = "phasespace.phsp";
+    G4int fPhaseSpaceParticles = 1;
+    std::shared_ptr<const PhaseSpaceReader> fPhaseSpace;
+    std::uint64_t fPhaseSpaceBegin = 0;   // share of this thread
+    std::uint64_t fPhaseSpaceEnd = 0;
+    std::uint64_t fPhaseSpaceNext = 0;
+    G4bool fPhaseSpaceRecycled = false;
+    std::unordered_map<G4int, const G4ParticleDefinition*> fParticles;
+
     G4ParticleGun* fParticleGun = nullptr; // pointer a to G4 gun class
-    G4Box* fEnvelopeBox = nullptr;
-    G4double GetEnergyFromSpectrum();
+    BeamProfile fBeamProfile;
     G4String fPrimaryParticleName;
     std::vector<G4double> fPrimaryEnergies;
 };
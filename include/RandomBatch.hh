@@ -0,0 +1,83 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file RandomBatch.hh
+/// \brief Definition of the B1::RandomBatch class
+
+#ifndef B1RandomBatch_h
+#define B1RandomBatch_h 1
+
+#include "Randomize.hh"
+#include "globals.hh"
+
+#include <vector>
+
+/// Block of uniform random numbers drawn at once from the engine of the
+/// thread with flatArray(), and handed out one by one by Flat().
+///
+/// Fill() draws exactly the numbers the caller knows it will use, so that
+/// none is wasted. The primary generator fills the block at the begin of
+/// every event with the count of its configuration; the numbers of an event
+/// then come only from the engine state the kernel seeded the event with,
+/// which keeps events reproducible in multi-threaded mode. A caller that
+/// needs more numbers than filled, such as a rejected candidate, gets them
+/// one at a time from the engine.
+///
+/// The block holds the numbers of one event only. The kernel reseeds the
+/// engine before every event in multi-threaded mode, so numbers drawn ahead
+/// for later events could not be used.
+
+namespace B1
+{
+
+class RandomBatch
+{
+  public:
+    void Fill(G4int n)
+    {
+      if (n > G4int(fBuffer.size())) fBuffer.resize(n);
+      if (n > 0) G4Random::getTheEngine()->flatArray(n, fBuffer.data());
+      fNext = 0;
+      fEnd = (n > 0) ? std::size_t(n) : 0;
+    }
+
+    G4double Flat()
+    {
+      if (fNext == fEnd) return G4Random::getTheEngine()->flat();
+      return fBuffer[fNext++];
+    }
+
+  private:
+    std::vector<G4double> fBuffer;
+    std::size_t fNext = 0;
+    std::size_t fEnd = 0;
+};
+
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
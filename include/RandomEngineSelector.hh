@@ -0,0 +1,77 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file RandomEngineSelector.hh
+/// \brief Definition of the B1::RandomEngineSelector class
+
+#ifndef B1RandomEngineSelector_h
+#define B1RandomEngineSelector_h 1
+
+#include "globals.hh"
+
+#include <memory>
+
+class G4GenericMessenger;
+
+namespace CLHEP
+{
+class HepRandomEngine;
+}
+
+/// Selection of the random engine with /b1/random/engine.
+///
+/// The engine is installed in the master before the run manager is
+/// initialised; in multi-threaded mode the workers get engines of the same
+/// type (see WorkerInitialization). Seeds set with /random/setSeeds apply to
+/// the engine installed at that time, so the engine has to be chosen first.
+
+namespace B1
+{
+
+class RandomEngineSelector
+{
+  public:
+    RandomEngineSelector();
+    ~RandomEngineSelector();
+
+    void SetEngine(const G4String& name);
+
+    // a new engine of the given type, nullptr for an unknown name
+    static CLHEP::HepRandomEngine* CreateEngine(const G4String& name);
+    static const G4String& GetEngineNames();
+
+  private:
+    void DefineCommands();
+
+    G4GenericMessenger* fMessenger = nullptr;
+    std::unique_ptr<CLHEP::HepRandomEngine> fEngine;
+};
+
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
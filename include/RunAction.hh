@@ -34,6 +34,19 @@
 #include "G4Accumulable.hh"
 #include "globals.hh"
 #include "PrimaryGeneratorAction.hh"
+#include "CascadeFinder.hh"
+#include "Checkpoint.hh"
+#include "EdepAccumulable.hh"
+#include "HistogramSet.hh"
+#include "OutputWriter.hh"
+#include "PhaseSpaceRecorder.hh"
+#include "PrecisionTarget.hh"
+#include "RunStatistics.hh"
+#include "Snapshot.hh"
+#include "StepProfiler.hh"
+
+#include <iosfwd>
+
 class G4Run;
 
 /// Run action class
@@ -55,14 +68,40 @@ class RunAction : public G4UserRunAction
     void   EndOfRunAction(const G4Run*) override;
 
     void AddEdep (G4double edep);
-    void SetPrimaryGenerator(const B1::PrimaryGeneratorAction* gen);
+    void CountEmptyEvent() { fEmptyEvents += 1; }
+    void SetPrimaryGenerator(B1::PrimaryGeneratorAction* gen);
     void SetPhysicsListName(const G4String& name);
 
+    RunStatistics& GetStatistics() { return fStatistics; }
+    StepProfiler& GetProfiler() { return fProfiler; }
+    OutputWriter& GetOutput() { return fOutput; }
+    PhaseSpaceRecorder& GetPhaseSpaceRecorder() { return fPhaseSpaceRecorder; }
+    Checkpoint& GetCheckpoint() { return fCheckpoint; }
+    Snapshot& GetSnapshot() { return fSnapshot; }
+    PrecisionTarget& GetPrecisionTarget() { return fPrecisionTarget; }
+    CascadeFinder& GetCascadeFinder() { return fCascadeFinder; }
+    const HistogramSet& GetHistograms() const { return fHistograms; }
+    G4double GetEdep() const { return fEdep.GetValue(); }
+
+    // state of the current run, see Checkpoint
+    void Save(std::ostream& out) const;
+    G4bool Restore(std::istream& in);
+
   private:
     G4Accumulable<G4double> fEdep = 0.;
-    G4Accumulable<G4double> fEdep2 = 0.;
-    const B1::PrimaryGeneratorAction* fPrimaryGenerator = nullptr;
+    G4Accumulable<G4long> fEmptyEvents = 0;   // no deposit, no recoil
+    EdepAccumulable fEdepPerEvent{"EdepPerEvent"};
+    B1::PrimaryGeneratorAction* fPrimaryGenerator = nullptr;
     G4String fPhysicsListName;
+    HistogramSet fHistograms;
+    RunStatistics fStatistics;
+    StepProfiler fProfiler;
+    OutputWriter fOutput;
+    PhaseSpaceRecorder fPhaseSpaceRecorder;
+    Checkpoint fCheckpoint{this};
+    Snapshot fSnapshot{this};
+    PrecisionTarget fPrecisionTarget;
+    CascadeFinder fCascadeFinder;
 };
 
 }
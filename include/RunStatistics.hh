@@ -0,0 +1,133 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file RunStatistics.hh
+/// \brief Definition of the B1::RunStatistics class
+
+#ifndef B1RunStatistics_h
+#define B1RunStatistics_h 1
+
+#include "G4Accumulable.hh"
+#include "globals.hh"
+
+#include <atomic>
+#include <chrono>
+#include <iosfwd>
+
+class G4GenericMessenger;
+
+/// Per-thread throughput counters of the user actions.
+///
+/// The counters are plain members incremented by the actions of the owning
+/// thread, so the hot path costs one flag test and an increment. They are
+/// copied to accumulables in EndOfRun() and merged with the other run
+/// results. In multi-threaded runs the master also reports, for each worker,
+/// the time spent outside events (idle). Commands are defined in the
+/// /b1/stats/ directory.
+
+namespace B1
+{
+
+class RunStatistics
+{
+  public:
+    RunStatistics();
+    ~RunStatistics();
+
+    void BeginOfRun(G4bool isMaster);
+    void EndOfRun();
+    void BeginOfEvent();
+    void EndOfEvent();
+
+    void CountStep(G4bool inScoringVolume);
+    void CountRecoil()     { if (fEnabled) ++fNofRecoils; }
+    void CountNtupleRow()  { if (fEnabled) ++fNofNtupleRows; }
+
+    void Print();
+
+    // local counters and elapsed time, for the checkpoints
+    void Save(std::ostream& out) const;
+    G4bool Restore(std::istream& in);
+
+    G4bool IsEnabled() const { return fEnabled; }
+    G4double GetNofEvents() const { return fEvents.GetValue(); }
+    G4double GetNofSteps() const { return fSteps.GetValue(); }
+    G4double GetRunTime() const { return fRunTime; }
+
+  private:
+    using Clock = std::chrono::steady_clock;
+
+    void DefineCommands();
+    void PrintProgress() const;
+    void PrintThreadLoads() const;
+    G4double Elapsed(Clock::time_point start) const;
+
+    G4GenericMessenger* fMessenger = nullptr;
+    G4bool fEnabled = true;
+    G4int  fPrintInterval = 0;
+    G4bool fIsMaster = true;
+
+    // local counters of the current run
+    G4long fNofEvents = 0;
+    G4long fNofSteps = 0;
+    G4long fNofScoringSteps = 0;
+    G4long fNofRecoils = 0;
+    G4long fNofNtupleRows = 0;
+    G4double fEventTime = 0.;
+    G4double fRunTime = 0.;
+    G4double fRestoredRunTime = 0.;   // of the run a checkpoint was taken from
+    G4long fNofStepsPublished = 0;
+    Clock::time_point fRunStart;
+    Clock::time_point fEventStart;
+
+    // totals of all threads, for the periodic aggregate rates
+    static std::atomic<G4long> fgTotalEvents;
+    static std::atomic<G4long> fgTotalSteps;
+    static Clock::time_point fgRunStart;
+
+    // merged results of the last run
+    G4Accumulable<G4double> fEvents = 0.;
+    G4Accumulable<G4double> fSteps = 0.;
+    G4Accumulable<G4double> fScoringSteps = 0.;
+    G4Accumulable<G4double> fRecoils = 0.;
+    G4Accumulable<G4double> fNtupleRows = 0.;
+    G4Accumulable<G4double> fEventTimeSum = 0.;
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+inline void RunStatistics::CountStep(G4bool inScoringVolume)
+{
+  if (!fEnabled) return;
+  ++fNofSteps;
+  if (inScoringVolume) ++fNofScoringSteps;
+}
+
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
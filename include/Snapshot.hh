@@ -0,0 +1,88 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file Snapshot.hh
+/// \brief Definition of the B1::Snapshot class
+
+#ifndef B1Snapshot_h
+#define B1Snapshot_h 1
+
+#include "globals.hh"
+
+#include <chrono>
+
+class G4GenericMessenger;
+
+/// Periodic snapshots of the merged histograms while a run is going on.
+///
+/// With /b1/snapshot/interval T every thread publishes, at the end of an
+/// event and at most once per T, a copy of its H1 bins, of its auto-ranged
+/// histograms and of its counters to a table shared by all threads. The
+/// thread whose publication finds the side file older than T sums the
+/// latest copies of all threads under the lock and writes the file outside
+/// of it, via <file>.tmp and a rename, so a reader never sees a partial
+/// file. The main output file is not touched.
+///
+/// The cost per interval is a copy of the bins per thread and a sum over
+/// the threads, independent of the number of events; the auto-ranged
+/// histograms are bounded by /b1/histo/maxBins.
+
+namespace B1
+{
+
+class RunAction;
+
+class Snapshot
+{
+  public:
+    Snapshot(RunAction* runAction);
+    ~Snapshot();
+
+    void BeginOfRun(G4bool isMaster);
+    void EndOfEvent();
+    void EndOfRun(G4bool isMaster);
+
+  private:
+    using Clock = std::chrono::steady_clock;
+
+    void Publish();
+    void DefineCommands();
+
+    RunAction* fRunAction = nullptr;
+    G4GenericMessenger* fMessenger = nullptr;
+    G4double fInterval = 0.;
+    G4String fFileName = "snapshot.txt";
+
+    G4bool fActive = false;
+    G4long fNofEvents = 0;
+    Clock::time_point fLastPublish;
+};
+
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
@@ -0,0 +1,105 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file SpscQueue.hh
+/// \brief Definition of the B1::SpscQueue class template
+
+#ifndef B1SpscQueue_h
+#define B1SpscQueue_h 1
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+/// Bounded lock-free queue with one producer and one consumer thread.
+///
+/// The capacity is rounded up to a power of two. Push() fails instead of
+/// blocking when the queue is full, so the producer decides how to apply
+/// backpressure; Pop() takes a whole batch at once.
+
+namespace B1
+{
+
+template <class T>
+class SpscQueue
+{
+  public:
+    explicit SpscQueue(std::size_t capacity)
+    {
+      std::size_t size = 2;
+      while (size < capacity) size <<= 1;
+      fBuffer.resize(size);
+      fMask = size - 1;
+    }
+
+    std::size_t Capacity() const { return fBuffer.size(); }
+
+    // producer side
+    bool Push(const T& item)
+    {
+      std::size_t tail = fTail.load(std::memory_order_relaxed);
+      if (tail - fHeadCache == fBuffer.size()) {
+        fHeadCache = fHead.load(std::memory_order_acquire);
+        if (tail - fHeadCache == fBuffer.size()) return false;
+      }
+      fBuffer[tail & fMask] = item;
+      fTail.store(tail + 1, std::memory_order_release);
+      return true;
+    }
+
+    // consumer side: copies up to maxItems items to out
+    std::size_t Pop(T* out, std::size_t maxItems)
+    {
+      std::size_t head = fHead.load(std::memory_order_relaxed);
+      std::size_t available = fTail.load(std::memory_order_acquire) - head;
+      std::size_t n = (available < maxItems) ? available : maxItems;
+      for (std::size_t i = 0; i < n; ++i) out[i] = fBuffer[(head + i) & fMask];
+      fHead.store(head + n, std::memory_order_release);
+      return n;
+    }
+
+    bool Empty() const
+    {
+      return fHead.load(std::memory_order_acquire)
+             == fTail.load(std::memory_order_acquire);
+    }
+
+  private:
+    std::vector<T> fBuffer;
+    std::size_t fMask = 0;
+
+    // head is written by the consumer, tail by the producer; keep them on
+    // separate cache lines
+    alignas(64) std::atomic<std::size_t> fHead{0};
+    alignas(64) std::atomic<std::size_t> fTail{0};
+    alignas(64) std::size_t fHeadCache = 0;  // producer's view of fHead
+};
+
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
@@ -0,0 +1,137 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file StepProfiler.hh
+/// \brief Definition of the B1::StepProfiler class
+
+#ifndef B1StepProfiler_h
+#define B1StepProfiler_h 1
+
+#include "globals.hh"
+
+#include <chrono>
+#include <cstdint>
+#include <unordered_map>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+class G4GenericMessenger;
+class G4LogicalVolume;
+class G4ParticleDefinition;
+class G4Step;
+class G4VProcess;
+
+/// Optional per-thread profiler of the stepping.
+///
+/// The time between two consecutive steps of a track, read from the cycle
+/// counter, is charged to the (volume, particle, defining process) bucket of
+/// the later step. Only one step in N is charged (/b1/profile/sampling), so
+/// that the bucket lookup stays off most steps; the counts and times are
+/// scaled back by N in the report. At the end of the run the thread tables
+/// are merged by name and the master prints the buckets sorted by cost.
+
+namespace B1
+{
+
+class StepProfiler
+{
+  public:
+    StepProfiler();
+    ~StepProfiler();
+
+    G4bool IsEnabled() const { return fEnabled; }
+
+    void BeginOfRun();
+    void EndOfRun();
+    void Print();
+
+    void BeginOfTrack() { if (fEnabled) fLastTicks = ReadTicks(); }
+    void Step(const G4Step* step, const G4LogicalVolume* volume);
+
+  private:
+    struct Key
+    {
+      const G4LogicalVolume* volume;
+      const G4ParticleDefinition* particle;
+      const G4VProcess* process;
+      G4bool operator==(const Key& other) const
+      {
+        return volume == other.volume && particle == other.particle
+               && process == other.process;
+      }
+    };
+    struct KeyHash
+    {
+      std::size_t operator()(const Key& key) const
+      {
+        auto h = reinterpret_cast<std::uintptr_t>(key.volume);
+        h = h * 31 + reinterpret_cast<std::uintptr_t>(key.particle);
+        h = h * 31 + reinterpret_cast<std::uintptr_t>(key.process);
+        return static_cast<std::size_t>(h ^ (h >> 17));
+      }
+    };
+    struct Bucket
+    {
+      G4double steps = 0.;
+      G4double ticks = 0.;
+    };
+
+    static std::uint64_t ReadTicks();
+    void DefineCommands();
+
+    G4GenericMessenger* fMessenger = nullptr;
+    G4bool fEnabled = false;
+    G4int fSampling = 1;
+    G4int fMaxRows = 30;
+
+    G4int fCountdown = 1;
+    std::uint64_t fLastTicks = 0;
+    std::uint64_t fRunStartTicks = 0;
+    std::chrono::steady_clock::time_point fRunStart;
+    std::unordered_map<Key, Bucket, KeyHash> fBuckets;
+    Key fLastKey = { nullptr, nullptr, nullptr };
+    Bucket* fLastBucket = nullptr;
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+inline std::uint64_t StepProfiler::ReadTicks()
+{
+#if defined(__x86_64__) || defined(__i386__)
+  return __rdtsc();
+#else
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+    std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
@@ -41,7 +41,12 @@ class G4LogicalVolume;
 namespace B1
 {
 
+class CascadeFinder;
+class DetectorConstruction;
 class EventAction;
+class PhaseSpaceRecorder;
+class RunStatistics;
+class StepProfiler;
 
 class SteppingAction : public G4UserSteppingAction
 {
@@ -54,7 +59,11 @@ class SteppingAction : public G4UserSteppingAction
 
   private:
     EventAction* fEventAction = nullptr;
-    G4LogicalVolume* fScoringVolume = nullptr;
+    const DetectorConstruction* fDetector = nullptr;
+    RunStatistics* fStatistics = nullptr;
+    StepProfiler* fProfiler = nullptr;
+    PhaseSpaceRecorder* fPhaseSpace = nullptr;
+    CascadeFinder* fCascadeFinder = nullptr;
 };
 
 }
@@ -0,0 +1,117 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file TrackAncestry.hh
+/// \brief Definition of the B1::TrackAncestry class
+
+#ifndef B1TrackAncestry_h
+#define B1TrackAncestry_h 1
+
+#include "G4Track.hh"
+#include "globals.hh"
+
+#include <vector>
+
+class G4VProcess;
+
+/// Parent, creator process and generation of every track of the event.
+///
+/// The kernel numbers the tracks of an event 1, 2, ... in the order they
+/// are created, so the records are kept in a vector indexed by track ID.
+/// Clear() only resets the size: after the first events the capacity is
+/// large enough and adding a track no longer allocates. A track is added
+/// when it starts (PreUserTrackingAction), after its parent, so that its
+/// generation is the one of the parent plus one. Primaries have parent 0
+/// and generation 0.
+
+namespace B1
+{
+
+class TrackAncestry
+{
+  public:
+    void Clear() { fNodes.clear(); }
+    void AddTrack(const G4Track* track);
+
+    G4bool Contains(G4int trackID) const
+    {
+      return trackID > 0 && trackID < G4int(fNodes.size())
+             && fNodes[trackID].generation >= 0;
+    }
+    // the lookups below return 0, nullptr and -1 for unknown tracks
+    G4int GetParentID(G4int trackID) const
+    {
+      return Contains(trackID) ? fNodes[trackID].parentID : 0;
+    }
+    const G4VProcess* GetCreatorProcess(G4int trackID) const
+    {
+      return Contains(trackID) ? fNodes[trackID].creator : nullptr;
+    }
+    G4int GetGeneration(G4int trackID) const
+    {
+      return Contains(trackID) ? fNodes[trackID].generation : -1;
+    }
+
+    // a secondary of a primary
+    G4bool IsPka(G4int trackID) const { return GetGeneration(trackID) == 1; }
+
+  private:
+    struct Node
+    {
+      G4int parentID = 0;
+      const G4VProcess* creator = nullptr;
+      G4int generation = -1;
+    };
+
+    std::vector<Node> fNodes;
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+inline void TrackAncestry::AddTrack(const G4Track* track)
+{
+  G4int trackID = track->GetTrackID();
+  if (trackID <= 0) return;
+  if (trackID >= G4int(fNodes.size())) fNodes.resize(trackID + 1);
+
+  Node& node = fNodes[trackID];
+  node.parentID = track->GetParentID();
+  node.creator = track->GetCreatorProcess();
+  if (node.parentID == 0) {
+    node.generation = 0;
+  }
+  else {
+    // stays unknown (-1) if the parent was not added
+    G4int parentGeneration = GetGeneration(node.parentID);
+    node.generation = (parentGeneration >= 0) ? parentGeneration + 1 : -1;
+  }
+}
+
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
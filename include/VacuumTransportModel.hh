@@ -0,0 +1,79 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file VacuumTransportModel.hh
+/// \brief Definition of the B1::VacuumTransportModel class
+
+#ifndef B1VacuumTransportModel_h
+#define B1VacuumTransportModel_h 1
+
+#include "G4VFastSimulationModel.hh"
+#include "globals.hh"
+
+class G4GenericMessenger;
+
+/// Fast simulation of the primaries in the vacuum envelope.
+///
+/// A primary that is located in the envelope itself, not in one of its
+/// daughters, is moved in one step along its direction to the nearest
+/// daughter it will enter, and killed if it misses all of them. Nothing
+/// else happens in the G4_Galactic envelope, so the tracking inside the
+/// daughters (the diamond) is unchanged. Only placed daughters are
+/// considered. /b1/fastsim/vacuumTransport switches the model off.
+///
+/// With the default source on the front face of the diamond, the primaries
+/// start on a daughter surface and only the kill of the primaries leaving
+/// the samples applies; the transport in needs an upstream source, see
+/// perf/vacuum_transport.mac.
+
+namespace B1
+{
+
+class VacuumTransportModel : public G4VFastSimulationModel
+{
+  public:
+    VacuumTransportModel(const G4String& name, G4Region* envelope);
+    ~VacuumTransportModel() override;
+
+    G4bool IsApplicable(const G4ParticleDefinition&) override { return true; }
+    G4bool ModelTrigger(const G4FastTrack& fastTrack) override;
+    void DoIt(const G4FastTrack& fastTrack, G4FastStep& fastStep) override;
+
+  private:
+    void DefineCommands();
+
+    G4GenericMessenger* fMessenger = nullptr;
+    G4bool fEnabled = true;
+
+    // found by ModelTrigger() for the following DoIt()
+    G4double fDistance = 0.;
+};
+
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
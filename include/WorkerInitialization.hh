@@ -0,0 +1,59 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file WorkerInitialization.hh
+/// \brief Definition of the B1::WorkerInitialization class
+
+#ifndef B1WorkerInitialization_h
+#define B1WorkerInitialization_h 1
+
+#include "G4UserWorkerThreadInitialization.hh"
+
+/// Worker thread initialization of the multi-threaded run managers.
+///
+/// The kernel gives every worker a new engine of the type of the master
+/// engine, but it knows only the CLHEP engine types. SetupRNGEngine()
+/// creates the engines of this example (PhiloxEngine) itself and leaves
+/// the others to the kernel; the workers are seeded per event by the
+/// master afterwards, as usual.
+
+namespace B1
+{
+
+class WorkerInitialization : public G4UserWorkerThreadInitialization
+{
+  public:
+    WorkerInitialization() = default;
+    ~WorkerInitialization() override = default;
+
+    void SetupRNGEngine(const CLHEP::HepRandomEngine* masterEngine) const override;
+};
+
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
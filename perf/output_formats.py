@@ -0,0 +1,102 @@
+#!/usr/bin/env python3
+"""Output format benchmark of example B1.
+
+Runs exampleB1 on one canned macro per output configuration and prints
+the wall time, the time spent on output (wall time minus that of the run
+without a file), the size of the output files and the write rate.
+
+  output_formats.py --exe exampleB1 --macro perf/proton_210MeV.mac \
+                    [--workdir DIR] [--formats root,csv,hdf5]
+                    [--compression 1,9] [--basket-size 0,65536]
+                    [--repeat 3]
+
+Every combination of format, compression level and basket size is run; 0
+and -1 keep the Geant4 defaults. Every configuration, and the run without
+a file, is run --repeat times and the smallest wall time is used. An output
+time within the noise of the reference is printed as "<noise" with no
+rate. A configuration that fails (e.g. hdf5 not built into Geant4) is
+listed as FAILED. The macro must not set /b1/output/ itself.
+"""
+
+import argparse
+import itertools
+import os
+import sys
+
+from perf_check import run_case
+
+
+def parse_list(text, convert):
+    return [convert(item) for item in text.split(",") if item]
+
+
+def run_config(exe, macro, workdir, name, commands, repeat):
+    """Runs the macro after the given commands repeat times, returns the
+    metrics of the fastest run."""
+    wrapper = os.path.join(workdir, name + ".mac")
+    with open(wrapper, "w") as out:
+        for command in commands:
+            out.write(command + "\n")
+        out.write("/control/execute %s\n" % os.path.abspath(macro))
+    # the output size is summed over all Mydata* files of the run
+    best = None
+    for _ in range(max(repeat, 1)):
+        metrics = run_case(exe, wrapper, os.path.join(workdir, name))
+        if best is None or metrics["wall_time_s"] < best["wall_time_s"]:
+            best = metrics
+    return best
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n")[0])
+    parser.add_argument("--exe", required=True)
+    parser.add_argument("--macro", required=True)
+    parser.add_argument("--workdir", default="output_formats")
+    parser.add_argument("--formats", default="root,csv,hdf5")
+    parser.add_argument("--compression", default="-1")
+    parser.add_argument("--basket-size", default="0")
+    parser.add_argument("--repeat", type=int, default=3)
+    args = parser.parse_args()
+
+    exe = os.path.abspath(args.exe)
+    os.makedirs(args.workdir, exist_ok=True)
+
+    reference = run_config(exe, args.macro, args.workdir, "none",
+                           ["/b1/output/format none"], args.repeat)
+    print("%-6s %5s %9s %10s %10s %12s %10s"
+          % ("format", "level", "basket", "wall_s", "output_s",
+             "output_MB", "MB/s"))
+    print("%-6s %5s %9s %10.2f %10s %12s %10s"
+          % ("none", "-", "-", reference["wall_time_s"], "-", "-", "-"))
+
+    failed = 0
+    configs = itertools.product(parse_list(args.formats, str),
+                                parse_list(args.compression, int),
+                                parse_list(args.basket_size, int))
+    for fmt, level, basket in configs:
+        name = "%s_c%d_b%d" % (fmt, level, basket)
+        try:
+            metrics = run_config(exe, args.macro, args.workdir, name, [
+                "/b1/output/format %s" % fmt,
+                "/b1/output/compression %d" % level,
+                "/b1/output/basketSize %d" % basket,
+            ], args.repeat)
+        except RuntimeError as error:
+            failed += 1
+            print("%-6s %5d %9d  FAILED: %s" % (fmt, level, basket, error))
+            continue
+        output_time = metrics["wall_time_s"] - reference["wall_time_s"]
+        size_mb = metrics["output_bytes"] / 1.0e6
+        if output_time > 0:
+            timing = "%10.2f %12.3f %10.1f" % (output_time, size_mb,
+                                               size_mb / output_time)
+        else:
+            # faster than the fastest run without output: below the noise
+            timing = "%10s %12.3f %10s" % ("<noise", size_mb, "-")
+        print("%-6s %5d %9d %10.2f %s"
+              % (fmt, level, basket, metrics["wall_time_s"], timing))
+    return 1 if failed else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
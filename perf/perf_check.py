@@ -0,0 +1,205 @@
+#!/usr/bin/env python3
+"""Performance regression check of example B1.
+
+Runs exampleB1 headless on one canned macro (fixed seeds, verbosity off),
+records wall time, peak RSS, steps per event and output size to JSON, and
+compares them with the stored baseline within relative tolerances.
+
+  perf_check.py --exe exampleB1 --macro perf/gamma_6MeV.mac --case gamma_6MeV \
+                --baseline perf/baseline.json --output perf/gamma_6MeV.json \
+                [--workdir DIR] [--update-baseline]
+
+Exit status is 1 if a metric regressed beyond its tolerance, 0 otherwise.
+A case without a baseline is not run and exits with status 77, which CTest
+reports as skipped (SKIP_RETURN_CODE). Record a missing case with
+--update-baseline on the reference machine.
+"""
+
+import argparse
+import glob
+import json
+import os
+import re
+import resource
+import shutil
+import subprocess
+import sys
+import time
+
+# Relative tolerances used when the baseline file does not define them.
+DEFAULT_TOLERANCES = {
+    "wall_time_s": 0.25,
+    "peak_rss_mb": 0.15,
+    "steps_per_event": 0.02,
+    "output_bytes": 0.10,
+}
+
+# Absolute differences below these are noise and never flagged.
+ABSOLUTE_SLACK = {
+    "wall_time_s": 0.5,
+    "peak_rss_mb": 5.0,
+}
+
+# Exit status of a case without a baseline; CTest reports it as skipped.
+SKIPPED = 77
+
+# Metrics whose change in either direction is flagged: with fixed seeds the
+# number of steps only moves when the simulation itself changed.
+TWO_SIDED = {"steps_per_event"}
+
+EVENTS_RE = re.compile(r"^ Events\s+:\s+(\S+)")
+STEPS_RE = re.compile(r"^ Steps\s+:\s+(\S+)")
+IDLE_RE = re.compile(r"^ Idle fraction\s+:\s+(\S+) %")
+WORKER_RE = re.compile(r"^\s+(\d+)\s+(\d+)\s+.*\((\S+) %\)\s*$")
+
+
+def run_case(exe, macro, workdir, options=()):
+    """Runs exampleB1 in workdir and returns the measured metrics.
+
+    options are command-line options such as ["-r", "mt", "-t", "8"]; with
+    more than one thread the metrics hold the idle fraction of the run and
+    the events and idle fraction of every worker (RunStatistics::Print).
+    """
+    if os.path.isdir(workdir):
+        shutil.rmtree(workdir)
+    os.makedirs(workdir)
+
+    events = 0.0
+    steps = 0.0
+    idle = None
+    workers = []
+    in_loads = False
+    command = [exe, os.path.abspath(macro)]
+    if options:
+        command = [exe] + list(options) + ["-m", os.path.abspath(macro)]
+    start = time.monotonic()
+    proc = subprocess.Popen(command, cwd=workdir,
+                            stdout=subprocess.PIPE,
+                            stderr=subprocess.STDOUT,
+                            universal_newlines=True, errors="replace")
+    # The actions are verbose; parse the run statistics on the fly instead
+    # of keeping the log.
+    tail = []
+    for line in proc.stdout:
+        match = EVENTS_RE.match(line)
+        if match:
+            events += float(match.group(1))
+        match = STEPS_RE.match(line)
+        if match:
+            steps += float(match.group(1))
+        if line.startswith(" Worker load"):
+            in_loads = True
+            workers = []
+        match = IDLE_RE.match(line)
+        if match:
+            idle = float(match.group(1))
+            in_loads = False
+        match = WORKER_RE.match(line) if in_loads else None
+        if match:
+            workers.append({"thread": int(match.group(1)),
+                            "events": int(match.group(2)),
+                            "idle_percent": float(match.group(3))})
+        tail.append(line)
+        del tail[:-20]
+    status = proc.wait()
+    wall = time.monotonic() - start
+
+    # ru_maxrss of the children is in kilobytes on Linux
+    peak_rss = resource.getrusage(resource.RUSAGE_CHILDREN).ru_maxrss / 1024.0
+
+    if status != 0:
+        sys.stderr.write("".join(tail))
+        raise RuntimeError("exampleB1 exited with status %d" % status)
+    if events <= 0:
+        raise RuntimeError("no run statistics found in the output; "
+                           "is /b1/stats/enable set in the macro?")
+
+    output_bytes = sum(os.path.getsize(path) for path in
+                       glob.glob(os.path.join(workdir, "Mydata*")))
+
+    metrics = {
+        "events": events,
+        "steps": steps,
+        "steps_per_event": steps / events,
+        "wall_time_s": round(wall, 3),
+        "peak_rss_mb": round(peak_rss, 1),
+        "output_bytes": output_bytes,
+    }
+    if idle is not None:
+        metrics["idle_percent"] = idle
+        metrics["workers"] = workers
+    return metrics
+
+
+def compare(measured, reference, tolerances):
+    """Returns the list of regressions of measured against reference."""
+    failures = []
+    for metric, tolerance in sorted(tolerances.items()):
+        if metric not in reference or metric not in measured:
+            continue
+        ref = float(reference[metric])
+        value = float(measured[metric])
+        change = (value - ref) / ref if ref else (1.0 if value else 0.0)
+        regressed = (abs(change) > tolerance if metric in TWO_SIDED
+                     else change > tolerance)
+        if abs(value - ref) <= ABSOLUTE_SLACK.get(metric, 0.0):
+            regressed = False
+        print("  %-16s %14.4g  baseline %14.4g  %+7.1f%%  (tolerance %.0f%%)%s"
+              % (metric, value, ref, 100 * change, 100 * tolerance,
+                 "  REGRESSION" if regressed else ""))
+        if regressed:
+            failures.append(metric)
+    return failures
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n")[0])
+    parser.add_argument("--exe", required=True)
+    parser.add_argument("--macro", required=True)
+    parser.add_argument("--case", required=True)
+    parser.add_argument("--baseline", required=True)
+    parser.add_argument("--output", required=True)
+    parser.add_argument("--workdir")
+    parser.add_argument("--update-baseline", action="store_true")
+    args = parser.parse_args()
+
+    baseline = {"tolerances": DEFAULT_TOLERANCES, "cases": {}}
+    if os.path.exists(args.baseline):
+        with open(args.baseline) as inp:
+            baseline = json.load(inp)
+    tolerances = dict(DEFAULT_TOLERANCES)
+    tolerances.update(baseline.get("tolerances", {}))
+    cases = baseline.setdefault("cases", {})
+
+    print("perf case %s (%s)" % (args.case, os.path.basename(args.macro)))
+    if args.case not in cases and not args.update_baseline:
+        print("  SKIPPED: no baseline for this case in %s; record one with "
+              "--update-baseline (target perf_baseline)" % args.baseline)
+        return SKIPPED
+
+    workdir = args.workdir or os.path.join(
+        os.path.dirname(os.path.abspath(args.output)), args.case)
+    measured = run_case(os.path.abspath(args.exe), args.macro, workdir)
+    measured["case"] = args.case
+    measured["macro"] = os.path.basename(args.macro)
+
+    with open(args.output, "w") as out:
+        json.dump(measured, out, indent=2, sort_keys=True)
+        out.write("\n")
+    if args.update_baseline:
+        cases[args.case] = {key: measured[key] for key in DEFAULT_TOLERANCES}
+        with open(args.baseline, "w") as out:
+            json.dump(baseline, out, indent=2, sort_keys=True)
+            out.write("\n")
+        print("  baseline updated in %s" % args.baseline)
+        return 0
+
+    failures = compare(measured, cases[args.case], tolerances)
+    if failures:
+        print("  FAILED: %s" % ", ".join(failures))
+        return 1
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,93 @@
+#!/usr/bin/env python3
+"""Event scheduling comparison of example B1.
+
+Runs exampleB1 on one canned macro with G4MTRunManager and with
+G4TaskRunManager at several grain sizes (events per task), with the same
+number of threads, and prints the wall time, the idle fraction of the run
+and the idle fraction of every worker (from RunStatistics::Print).
+
+  scheduling.py --exe exampleB1 --macro perf/proton_24GeV.mac \
+                [--threads 8] [--grains 1,10,100] [--repeat 3]
+                [--workdir DIR] [--output scheduling.json]
+
+Every configuration is run --repeat times; the run with the smallest wall
+time is reported. The macro must set /b1/stats/enable true.
+"""
+
+import argparse
+import json
+import os
+import sys
+
+from perf_check import run_case
+
+
+def parse_list(text, convert):
+    return [convert(item) for item in text.split(",") if item]
+
+
+def fastest(exe, macro, workdir, name, options, repeat):
+    """Runs one configuration repeat times, returns the fastest run."""
+    best = None
+    for index in range(repeat):
+        metrics = run_case(exe, macro,
+                           os.path.join(workdir, "%s_%d" % (name, index)),
+                           options)
+        if best is None or metrics["wall_time_s"] < best["wall_time_s"]:
+            best = metrics
+    return best
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n")[0])
+    parser.add_argument("--exe", required=True)
+    parser.add_argument("--macro", required=True)
+    parser.add_argument("--threads", type=int, default=os.cpu_count() or 2)
+    parser.add_argument("--grains", default="1,10,100")
+    parser.add_argument("--repeat", type=int, default=1)
+    parser.add_argument("--workdir", default="scheduling")
+    parser.add_argument("--output")
+    args = parser.parse_args()
+
+    exe = os.path.abspath(args.exe)
+    os.makedirs(args.workdir, exist_ok=True)
+    threads = ["-t", str(args.threads)]
+
+    configs = [("mt", "-", ["-r", "mt"] + threads)]
+    for grain in parse_list(args.grains, int):
+        configs.append(("tasking", str(grain),
+                        ["-r", "tasking"] + threads + ["-g", str(grain)]))
+
+    print("%d threads, %s, fastest of %d"
+          % (args.threads, os.path.basename(args.macro), args.repeat))
+    print("%-8s %6s %10s %8s  %s"
+          % ("mode", "grain", "wall_s", "idle_%", "worker idle_% (events)"))
+    results = []
+    for mode, grain, options in configs:
+        name = mode if grain == "-" else "%s_g%s" % (mode, grain)
+        try:
+            metrics = fastest(exe, args.macro, args.workdir, name, options,
+                              max(args.repeat, 1))
+        except RuntimeError as error:
+            print("%-8s %6s  FAILED: %s" % (mode, grain, error))
+            continue
+        workers = " ".join("%.1f(%d)" % (worker["idle_percent"],
+                                         worker["events"])
+                           for worker in metrics.get("workers", []))
+        idle = metrics.get("idle_percent")
+        print("%-8s %6s %10.2f %8s  %s"
+              % (mode, grain, metrics["wall_time_s"],
+                 "%.1f" % idle if idle is not None else "-", workers))
+        metrics.update({"mode": mode, "grain": grain,
+                        "threads": args.threads})
+        results.append(metrics)
+
+    if args.output:
+        with open(args.output, "w") as out:
+            json.dump(results, out, indent=2, sort_keys=True)
+            out.write("\n")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,179 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file BeamProfile.cc
+/// \brief Implementation of the B1::BeamProfile class
+
+#include "BeamProfile.hh"
+#include "RandomBatch.hh"
+
+#include "G4GenericMessenger.hh"
+#include "G4PhysicalConstants.hh"
+#include "G4SystemOfUnits.hh"
+
+#include <cmath>
+
+namespace B1
+{
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+BeamProfile::BeamProfile()
+{
+  DefineCommands();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+BeamProfile::~BeamProfile()
+{
+  delete fMessenger;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void BeamProfile::Update()
+{
+  fHalfSize = 0.5 * fSize;
+  fRasterPitch = fSize / fRasterPoints;
+  fRasterCells = fRasterPoints * fRasterPoints;
+  fDirty = false;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void BeamProfile::Generate(RandomBatch& random, G4int eventID,
+                           G4ThreeVector& position, G4ThreeVector& direction)
+{
+  if (fDirty) Update();
+
+  G4double x = 0., y = 0.;
+  switch (fShape) {
+    case Shape::kPencil:
+      break;
+    case Shape::kGaussian: {
+      // Box-Muller, both normals used
+      G4double r = fSigma * std::sqrt(-2. * std::log(random.Flat()));
+      G4double phi = twopi * random.Flat();
+      x = r * std::cos(phi);
+      y = r * std::sin(phi);
+      break;
+    }
+    case Shape::kSquare:
+      x = fSize * (random.Flat() - 0.5);
+      y = fSize * (random.Flat() - 0.5);
+      break;
+    case Shape::kDisk: {
+      G4double r = fHalfSize * std::sqrt(random.Flat());
+      G4double phi = twopi * random.Flat();
+      x = r * std::cos(phi);
+      y = r * std::sin(phi);
+      break;
+    }
+    case Shape::kRaster: {
+      G4int cell = eventID % fRasterCells;
+      x = -fHalfSize + (cell % fRasterPoints + 0.5) * fRasterPitch;
+      y = -fHalfSize + (cell / fRasterPoints + 0.5) * fRasterPitch;
+      break;
+    }
+  }
+  position.set(fCentre.x() + x, fCentre.y() + y, fCentre.z());
+
+  if (fDivergence > 0.) {
+    G4double r = fDivergence * std::sqrt(-2. * std::log(random.Flat()));
+    G4double phi = twopi * random.Flat();
+    direction.set(std::tan(r * std::cos(phi)), std::tan(r * std::sin(phi)), 1.);
+    direction = direction.unit();
+  }
+  else {
+    direction.set(0., 0., 1.);
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4int BeamProfile::NumbersPerEvent() const
+{
+  G4int n = (fShape == Shape::kPencil || fShape == Shape::kRaster) ? 0 : 2;
+  if (fDivergence > 0.) n += 2;
+  return n;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void BeamProfile::SetProfile(const G4String& name)
+{
+  if (name == "pencil") fShape = Shape::kPencil;
+  else if (name == "gaussian") fShape = Shape::kGaussian;
+  else if (name == "square") fShape = Shape::kSquare;
+  else if (name == "disk") fShape = Shape::kDisk;
+  else if (name == "raster") fShape = Shape::kRaster;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void BeamProfile::DefineCommands()
+{
+  fMessenger = new G4GenericMessenger(this, "/b1/gun/",
+                                      "Primary generator");
+
+  fMessenger->DeclareMethod("profile", &BeamProfile::SetProfile,
+                            "Transverse beam profile.")
+    .SetParameterName("profile", false)
+    .SetCandidates("pencil gaussian square disk raster");
+
+  fMessenger->DeclareMethodWithUnit("centre", "nm", &BeamProfile::SetCentre,
+                                    "Centre of the beam spot.")
+    .SetParameterName("centre", false);
+
+  fMessenger->DeclareMethodWithUnit("size", "nm", &BeamProfile::SetSize,
+                                    "Full width of the square and raster "
+                                    "profiles, diameter of the disk.")
+    .SetParameterName("size", false)
+    .SetRange("size>=0.");
+
+  fMessenger->DeclareMethodWithUnit("sigma", "nm", &BeamProfile::SetSigma,
+                                    "Standard deviation of the gaussian "
+                                    "profile in x and y.")
+    .SetParameterName("sigma", false)
+    .SetRange("sigma>=0.");
+
+  fMessenger->DeclareMethodWithUnit("divergence", "mrad",
+                                    &BeamProfile::SetDivergence,
+                                    "Standard deviation of the beam angle "
+                                    "in x and y (0 = parallel beam).")
+    .SetParameterName("sigma", false)
+    .SetRange("sigma>=0.");
+
+  fMessenger->DeclareMethod("rasterPoints", &BeamProfile::SetRasterPoints,
+                            "Number of raster points per side.")
+    .SetParameterName("N", false)
+    .SetRange("N>=1");
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+}
@@ -0,0 +1,251 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file CascadeFinder.cc
+/// \brief Implementation of the B1::CascadeFinder class
+
+#include "CascadeFinder.hh"
+#include "OutputWriter.hh"
+
+#include "G4GenericMessenger.hh"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+namespace B1
+{
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+CascadeFinder::CascadeFinder()
+{
+  DefineCommands();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+CascadeFinder::~CascadeFinder()
+{
+  delete fMessenger;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void CascadeFinder::Book(OutputWriter& output)
+{
+  fNtupleId = output.CreateNtuple("Cascades", "Recoil clusters");
+  output.CreateNtupleIColumn("Event");
+  output.CreateNtupleIColumn("Recoils");
+  output.CreateNtupleIColumn("Points");
+  output.CreateNtupleDColumn("Energy");
+  output.CreateNtupleDColumn("x");
+  output.CreateNtupleDColumn("y");
+  output.CreateNtupleDColumn("z");
+  output.CreateNtupleDColumn("dx");
+  output.CreateNtupleDColumn("dy");
+  output.CreateNtupleDColumn("dz");
+  output.FinishNtuple();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void CascadeFinder::EndOfEvent(G4int eventID, OutputWriter& output)
+{
+  if (!fEnabled || fPoints.empty()) return;
+
+  for (const auto& cluster : FindClusters()) {
+    output.FillNtupleIColumn(fNtupleId, 0, eventID);
+    output.FillNtupleIColumn(fNtupleId, 1, cluster.recoils);
+    output.FillNtupleIColumn(fNtupleId, 2, cluster.points);
+    output.FillNtupleDColumn(fNtupleId, 3, cluster.energy);
+    for (G4int k = 0; k < 3; ++k) {
+      output.FillNtupleDColumn(fNtupleId, 4 + k, cluster.sum[k] / cluster.points);
+      output.FillNtupleDColumn(fNtupleId, 7 + k, cluster.max[k] - cluster.min[k]);
+    }
+    output.AddNtupleRow(fNtupleId);
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+const std::vector<CascadeFinder::Cluster>& CascadeFinder::FindClusters()
+{
+  fClusters.clear();
+  if (fPoints.empty()) return fClusters;
+
+  BuildGrid();
+
+  // join every point with the points of the 27 neighbouring cells that are
+  // within the radius; each pair is tested once, from its later point
+  const G4int nofPoints = G4int(fPoints.size());
+  const G4double radius2 = fRadius * fRadius;
+  fParent.resize(nofPoints);
+  fSize.assign(nofPoints, 1);
+  for (G4int i = 0; i < nofPoints; ++i) fParent[i] = i;
+
+  for (G4int i = 0; i < nofPoints; ++i) {
+    const Point& point = fPoints[i];
+    auto ix = G4long(std::floor(point.x / fRadius));
+    auto iy = G4long(std::floor(point.y / fRadius));
+    auto iz = G4long(std::floor(point.z / fRadius));
+    for (G4long dx = -1; dx <= 1; ++dx) {
+      for (G4long dy = -1; dy <= 1; ++dy) {
+        for (G4long dz = -1; dz <= 1; ++dz) {
+          G4int slot = FindSlot(ix + dx, iy + dy, iz + dz);
+          for (G4int j = fCells[slot].head; j >= 0; j = fNext[j]) {
+            if (j >= i) continue;
+            const Point& other = fPoints[j];
+            G4double d2 = (point.x - other.x) * (point.x - other.x)
+                          + (point.y - other.y) * (point.y - other.y)
+                          + (point.z - other.z) * (point.z - other.z);
+            if (d2 <= radius2) Join(i, j);
+          }
+        }
+      }
+    }
+  }
+
+  // sum the points of each cluster
+  fClusterOf.assign(nofPoints, -1);
+  for (G4int i = 0; i < nofPoints; ++i) {
+    const Point& point = fPoints[i];
+    const G4double position[3] = { point.x, point.y, point.z };
+    G4int root = FindRoot(i);
+    if (fClusterOf[root] < 0) {
+      fClusterOf[root] = G4int(fClusters.size());
+      Cluster cluster = {};
+      for (G4int k = 0; k < 3; ++k) {
+        cluster.min[k] = position[k];
+        cluster.max[k] = position[k];
+      }
+      fClusters.push_back(cluster);
+    }
+    Cluster& cluster = fClusters[fClusterOf[root]];
+    if (point.vertex) ++cluster.recoils;
+    ++cluster.points;
+    cluster.energy += point.energy;
+    for (G4int k = 0; k < 3; ++k) {
+      cluster.sum[k] += position[k];
+      cluster.min[k] = std::min(cluster.min[k], position[k]);
+      cluster.max[k] = std::max(cluster.max[k], position[k]);
+    }
+  }
+  return fClusters;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void CascadeFinder::BuildGrid()
+{
+  // open addressing in a table of at least twice as many slots as points;
+  // the points of a cell are chained through fNext
+  std::size_t nofSlots = 16;
+  while (nofSlots < 2 * fPoints.size()) nofSlots <<= 1;
+  fCells.assign(nofSlots, { 0, 0, 0, -1 });
+  fNext.assign(fPoints.size(), -1);
+
+  for (std::size_t i = 0; i < fPoints.size(); ++i) {
+    const Point& point = fPoints[i];
+    auto ix = G4long(std::floor(point.x / fRadius));
+    auto iy = G4long(std::floor(point.y / fRadius));
+    auto iz = G4long(std::floor(point.z / fRadius));
+    Cell& cell = fCells[FindSlot(ix, iy, iz)];
+    if (cell.head < 0) cell = { ix, iy, iz, -1 };
+    fNext[i] = cell.head;
+    cell.head = G4int(i);
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4int CascadeFinder::FindSlot(G4long ix, G4long iy, G4long iz) const
+{
+  // the slot of the cell, or the free slot where it would be inserted
+  const std::size_t mask = fCells.size() - 1;
+  std::uint64_t hash = std::uint64_t(ix) * 73856093u
+                       ^ std::uint64_t(iy) * 19349663u
+                       ^ std::uint64_t(iz) * 83492791u;
+  std::size_t slot = std::size_t(hash ^ (hash >> 29)) & mask;
+  while (true) {
+    const Cell& cell = fCells[slot];
+    if (cell.head < 0 || (cell.ix == ix && cell.iy == iy && cell.iz == iz)) {
+      return G4int(slot);
+    }
+    slot = (slot + 1) & mask;
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4int CascadeFinder::FindRoot(G4int i)
+{
+  // path halving
+  while (fParent[i] != i) {
+    fParent[i] = fParent[fParent[i]];
+    i = fParent[i];
+  }
+  return i;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void CascadeFinder::Join(G4int i, G4int j)
+{
+  // union by size
+  i = FindRoot(i);
+  j = FindRoot(j);
+  if (i == j) return;
+  if (fSize[i] < fSize[j]) std::swap(i, j);
+  fParent[j] = i;
+  fSize[i] += fSize[j];
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void CascadeFinder::DefineCommands()
+{
+  fMessenger = new G4GenericMessenger(this, "/b1/cascade/",
+                                      "Clustering of the recoils of an event");
+
+  fMessenger->DeclareProperty("enable", fEnabled,
+                              "Cluster the recoil vertices and end points of "
+                              "every event into the Cascades ntuple.")
+    .SetParameterName("enable", true)
+    .SetDefaultValue("true")
+    .SetStates(G4State_PreInit, G4State_Idle);
+
+  fMessenger->DeclarePropertyWithUnit("radius", "nm", fRadius,
+                                      "Points closer than the radius belong "
+                                      "to the same cluster.")
+    .SetParameterName("radius", false)
+    .SetRange("radius>0.")
+    .SetStates(G4State_PreInit, G4State_Idle);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+}
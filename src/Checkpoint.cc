@@ -0,0 +1,373 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file Checkpoint.cc
+/// \brief Implementation of the B1::Checkpoint class
+
+#include "Checkpoint.hh"
+#include "HistogramIO.hh"
+#include "RunAction.hh"
+
+#include "G4AnalysisManager.hh"
+#include "G4GenericMessenger.hh"
+#include "G4Run.hh"
+#include "G4RunManager.hh"
+#include "G4Threading.hh"
+#include "Randomize.hh"
+
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+
+namespace B1
+{
+
+G4int Checkpoint::fgEventOffset = 0;
+
+namespace
+{
+  const char* kCheckpointTag = "B1Checkpoint";
+  const G4int kCheckpointVersion = 4;
+
+  // name of the output file on disk; the extension is added by the
+  // analysis manager when it is missing
+  G4String OutputFileName(const G4String& fileName)
+  {
+    auto slash = fileName.rfind('/');
+    auto dot = fileName.rfind('.');
+    if (dot != G4String::npos && (slash == G4String::npos || dot > slash)) {
+      return fileName;
+    }
+    return fileName + "." + G4AnalysisManager::Instance()->GetFileType();
+  }
+
+  // <name>_seg<k>.<ext>
+  G4String SegmentFileName(const G4String& fileName, G4int segment)
+  {
+    auto dot = fileName.rfind('.');
+    std::ostringstream name;
+    name << fileName.substr(0, dot) << "_seg" << segment << fileName.substr(dot);
+    return name.str();
+  }
+
+  G4bool Expect(std::istream& in, const char* tag)
+  {
+    std::string word;
+    in >> word;
+    return bool(in) && word == tag;
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+Checkpoint::Checkpoint(RunAction* runAction)
+: fRunAction(runAction)
+{
+  DefineCommands();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+Checkpoint::~Checkpoint()
+{
+  delete fMessenger;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void Checkpoint::BeginOfRun(const G4Run* run)
+{
+  fResumedEvents = 0;
+  fgEventOffset = 0;
+  fSegment = 0;
+  fTarget = run->GetNumberOfEventToBeProcessed();
+
+  G4bool requested = fEveryEvents > 0 || fEveryMinutes > 0.;
+  fActive = requested && !G4Threading::IsMultithreadedApplication();
+  if (requested && !fActive && G4Threading::IsMasterThread()) {
+    G4ExceptionDescription msg;
+    msg << "Checkpoints are taken in sequential mode only; "
+        << "this run has none.";
+    G4Exception("Checkpoint::BeginOfRun()", "MyCode0005", JustWarning, msg);
+  }
+
+  // a segment is one renamed file; formats that write a file per ntuple
+  // or histogram cannot be segmented without losing the earlier rows
+  auto analysisManager = G4AnalysisManager::Instance();
+  if (fActive && analysisManager->IsOpenFile()
+      && analysisManager->GetFileType() != "root"
+      && analysisManager->GetFileType() != "hdf5") {
+    G4ExceptionDescription msg;
+    msg << "Checkpoints need a single output file (root or hdf5, or none); "
+        << "the format " << analysisManager->GetFileType()
+        << " writes several files.";
+    G4Exception("Checkpoint::BeginOfRun()", "MyCode0005",
+                FatalException, msg);
+  }
+
+  if (!fPending.empty()) {
+    // called after the accumulables were reset and the output was opened
+    std::istringstream in(fPending);
+    fPending.clear();
+    if (!Restore(in)) {
+      G4ExceptionDescription msg;
+      msg << "Checkpoint " << fFileName << " does not match the current "
+          << "setup and cannot be resumed.";
+      G4Exception("Checkpoint::BeginOfRun()", "MyCode0005",
+                  FatalException, msg);
+    }
+  }
+
+  fEvents = fResumedEvents;
+  fLastEvents = fEvents;
+  fLastTime = Clock::now();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void Checkpoint::EndOfEvent()
+{
+  if (!fActive) return;
+
+  // the last event is followed by the end of the run
+  if (++fEvents >= fTarget) return;
+
+  G4bool due = fEveryEvents > 0 && fEvents - fLastEvents >= fEveryEvents;
+  if (!due && fEveryMinutes > 0.) {
+    std::chrono::duration<G4double, std::ratio<60>> elapsed
+      = Clock::now() - fLastTime;
+    due = elapsed.count() >= fEveryMinutes;
+  }
+  if (due) Write();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void Checkpoint::EndOfRun(const G4Run* run)
+{
+  // nothing is left to resume once the target is reached
+  if ((fActive || fResumedEvents > 0)
+      && fResumedEvents + run->GetNumberOfEvent() >= fTarget) {
+    std::remove(fFileName.c_str());
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void Checkpoint::RotateOutput()
+{
+  auto analysisManager = G4AnalysisManager::Instance();
+  if (!analysisManager->IsOpenFile()) return;
+
+  G4String fileName = analysisManager->GetFileName();
+  G4String diskName = OutputFileName(fileName);
+
+  // the histograms are kept, only the ntuple starts anew
+  analysisManager->Write();
+  analysisManager->CloseFile(false);
+  ++fSegment;
+  if (std::rename(diskName.c_str(),
+                  SegmentFileName(diskName, fSegment).c_str()) != 0) {
+    G4ExceptionDescription msg;
+    msg << "Output file " << diskName << " cannot be renamed; its ntuple "
+        << "rows would be overwritten.";
+    G4Exception("Checkpoint::RotateOutput()", "MyCode0005",
+                FatalException, msg);
+  }
+  analysisManager->OpenFile(fileName);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void Checkpoint::Write()
+{
+  // the rows of the asynchronous writer are rotated with the file
+  RotateOutput();
+  fRunAction->GetOutput().RotateRows(fSegment);
+
+  std::ostringstream out;
+  out << kCheckpointTag << ' ' << kCheckpointVersion << '\n'
+      << "events " << fEvents << " target " << fTarget
+      << " segment " << fSegment << '\n';
+
+  auto engine = G4Random::getTheEngine();
+  std::vector<unsigned long> state = engine->put();
+  out << "engine " << engine->name() << ' ' << state.size();
+  for (auto word : state) out << ' ' << word;
+  out << '\n';
+
+  // the part file of the recorder is appended to on resume
+  auto& recorder = fRunAction->GetPhaseSpaceRecorder();
+  G4bool recording = recorder.IsRecording();
+  out << "phasespace " << recording << ' ' << recorder.Sync() << '\n';
+
+  out << "run\n";
+  fRunAction->Save(out);
+  HistogramIO::WriteAll(out);
+  out << "end\n";
+
+  // a killed job leaves either the previous checkpoint or this one
+  G4String tmpName = fFileName + ".tmp";
+  std::ofstream file(tmpName, std::ios::trunc);
+  file << out.str();
+  file.close();
+  if (!file || std::rename(tmpName.c_str(), fFileName.c_str()) != 0) {
+    G4ExceptionDescription msg;
+    msg << "Checkpoint " << fFileName << " cannot be written.";
+    G4Exception("Checkpoint::Write()", "MyCode0005", JustWarning, msg);
+    return;
+  }
+
+  fLastEvents = fEvents;
+  fLastTime = Clock::now();
+  G4cout << "Checkpoint: " << fEvents << " of " << fTarget
+         << " events written to " << fFileName << G4endl;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool Checkpoint::Restore(std::istream& in)
+{
+  G4int version = 0;
+  if (!Expect(in, kCheckpointTag)) return false;
+  in >> version;
+  if (version != kCheckpointVersion) return false;
+
+  if (!Expect(in, "events")) return false;
+  in >> fResumedEvents;
+  if (!Expect(in, "target")) return false;
+  in >> fTarget;
+  if (!Expect(in, "segment")) return false;
+  in >> fSegment;
+
+  std::string engineName;
+  std::size_t stateSize = 0;
+  if (!Expect(in, "engine")) return false;
+  in >> engineName >> stateSize;
+  std::vector<unsigned long> state(stateSize);
+  for (auto& word : state) in >> word;
+  auto engine = G4Random::getTheEngine();
+  if (!in || engineName != engine->name() || !engine->get(state)) {
+    return false;
+  }
+
+  G4bool recording = false;
+  std::uint64_t nofRecords = 0;
+  if (!Expect(in, "phasespace")) return false;
+  in >> recording >> nofRecords;
+  if (!in || !fRunAction->GetPhaseSpaceRecorder().Restore(recording, nofRecords)) {
+    return false;
+  }
+
+  if (!Expect(in, "run") || !fRunAction->Restore(in)) return false;
+  if (!HistogramIO::ReadAll(in)) return false;
+  if (!Expect(in, "end")) return false;
+
+  fgEventOffset = fResumedEvents;
+  return true;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void Checkpoint::Resume(const G4String& fileName)
+{
+  if (G4Threading::IsMultithreadedApplication()) {
+    G4ExceptionDescription msg;
+    msg << "Checkpoints are resumed in sequential mode only.";
+    G4Exception("Checkpoint::Resume()", "MyCode0005", JustWarning, msg);
+    return;
+  }
+
+  std::ifstream file(fileName);
+  std::ostringstream content;
+  content << file.rdbuf();
+
+  std::istringstream in(content.str());
+  G4int version = 0, events = 0, target = 0;
+  G4bool valid = Expect(in, kCheckpointTag) && (in >> version)
+                 && version == kCheckpointVersion
+                 && Expect(in, "events") && (in >> events)
+                 && Expect(in, "target") && (in >> target);
+  if (!valid) {
+    G4ExceptionDescription msg;
+    msg << "File " << fileName << " is not a checkpoint.";
+    G4Exception("Checkpoint::Resume()", "MyCode0005", JustWarning, msg);
+    return;
+  }
+  if (events >= target) {
+    G4cout << "Checkpoint " << fileName << ": all " << target
+           << " events are done." << G4endl;
+    return;
+  }
+
+  // further checkpoints of the resumed run replace this one
+  fPending = content.str();
+  fFileName = fileName;
+  G4cout << "Checkpoint " << fileName << ": resuming after " << events
+         << " of " << target << " events." << G4endl;
+  G4RunManager::GetRunManager()->BeamOn(target - events);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void Checkpoint::DefineCommands()
+{
+  fMessenger = new G4GenericMessenger(this, "/b1/checkpoint/",
+                                      "Checkpoints of long runs");
+
+  fMessenger->DeclareProperty("everyEvents", fEveryEvents,
+                              "Take a checkpoint every N events (0: never). "
+                              "Sequential runs (-r serial) only: multi-"
+                              "threaded and tasking runs take none.")
+    .SetParameterName("N", false)
+    .SetRange("N>=0")
+    .SetStates(G4State_PreInit, G4State_Idle);
+
+  fMessenger->DeclareProperty("everyMinutes", fEveryMinutes,
+                              "Take a checkpoint every T minutes of wall "
+                              "time (0: never). Sequential runs (-r serial) "
+                              "only.")
+    .SetParameterName("T", false)
+    .SetRange("T>=0.")
+    .SetStates(G4State_PreInit, G4State_Idle);
+
+  fMessenger->DeclareProperty("file", fFileName,
+                              "Name of the checkpoint file.")
+    .SetStates(G4State_PreInit, G4State_Idle);
+
+  fMessenger->DeclareMethod("resume", &Checkpoint::Resume,
+                            "Run the events left to the target of the run "
+                            "the checkpoint file was taken from. Sequential "
+                            "runs (-r serial) only.")
+    .SetParameterName("file", false)
+    .SetStates(G4State_Idle)
+    .SetToBeBroadcasted(false);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+}
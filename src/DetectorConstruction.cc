@@ -28,8 +28,11 @@
 /// \brief Implementation of the B1::DetectorConstruction class
 
 #include "DetectorConstruction.hh"
+#include "DiamondSD.hh"
+#include "VacuumTransportModel.hh"
 
 #include "G4RunManager.hh"
+#include "G4GenericMessenger.hh"
 #include "G4NistManager.hh"
 #include "G4Box.hh"
 #include "G4Cons.hh"
@@ -38,7 +41,17 @@
 #include "G4Trd.hh"
 #include "G4LogicalVolume.hh"
 #include "G4PVPlacement.hh"
+#include "G4PVReplica.hh"
+#include "G4Region.hh"
+#include "G4RegionStore.hh"
+#include "G4SDManager.hh"
+#include "G4StateManager.hh"
 #include "G4SystemOfUnits.hh"
+#include "G4UnitsTable.hh"
+#include "G4Threading.hh"
+#include "G4VTouchable.hh"
+
+#include <sstream>
 
 namespace B1
 {
@@ -46,12 +59,17 @@ namespace B1
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
 DetectorConstruction::DetectorConstruction()
-{}
+: fPitch(1.*um)
+{
+  DefineCommands();
+}
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
 DetectorConstruction::~DetectorConstruction()
-{}
+{
+  delete fMessenger;
+}
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
@@ -116,6 +134,13 @@ G4VPhysicalVolume* DetectorConstruction::Construct()
                     0,                       //copy number
                     checkOverlaps);          //overlaps checking
 
+  // region of the fast transport through the vacuum; kept when the
+  // geometry is rebuilt
+  G4Region* envelopeRegion
+    = G4RegionStore::GetInstance()->GetRegion("EnvelopeRegion", false);
+  if (!envelopeRegion) envelopeRegion = new G4Region("EnvelopeRegion");
+  envelopeRegion->AddRootLogicalVolume(logicEnv);
+
   //
   // Shape 1
   //
@@ -149,9 +174,8 @@ G4VPhysicalVolume* DetectorConstruction::Construct()
  //Define diamond
 
 
-G4double A = 12.01 * g/mole;
-G4double Z = 6;
- G4Material* diamond = new G4Material("diamond", Z, A, 3.515*g/cm3);
+  // diamond unless changed with /b1/det/material, density and dopant
+  G4Material* diamond = BuildSampleMaterial();
   G4ThreeVector pos = G4ThreeVector(0, 0*cm, 0.015*cm);
   
   G4double diamond_sizeXY = 200*nm, diamond_sizeZ = 0.015*cm;
@@ -162,24 +186,82 @@ G4double Z = 6;
     new G4LogicalVolume(solidShape,         //its solid
                        diamond, 
                         "Shape");           //its name
-    
-  new G4PVPlacement(0,                       //no rotation
-                    pos,                    //at position
-                    logicShape,             //its logical volume
-                    "Shape",                //its name
-                    logicEnv,                //its mother  volume
-                    false,                   //no boolean operation
-                    0,                       //copy number
-                    checkOverlaps);          //overlaps checking
+  fSampleVolume = logicShape;
+  fScoringVolume = logicShape;
+
+  // stack of layers along z, filling the sample
+  if (fNofLayers > 1) {
+    G4double layerSizeZ = diamond_sizeZ / fNofLayers;
+    auto solidLayer
+      = new G4Box("Layer", diamond_sizeXY, diamond_sizeXY, layerSizeZ);
+    auto logicLayer = new G4LogicalVolume(solidLayer, diamond, "Layer");
+    new G4PVReplica("Layer", logicLayer, logicShape, kZAxis, fNofLayers,
+                    2*layerSizeZ);
+    fScoringVolume = logicLayer;
+  }
+
+  // the envelope and the world are centred at the origin
+  G4ThreeVector halfSize(diamond_sizeXY, diamond_sizeXY, diamond_sizeZ);
+
+  if (fNofSamplesX * fNofSamplesY == 1) {
+    new G4PVPlacement(0,                       //no rotation
+                      pos,                    //at position
+                      logicShape,             //its logical volume
+                      "Shape",                //its name
+                      logicEnv,                //its mother  volume
+                      false,                   //no boolean operation
+                      0,                       //copy number
+                      checkOverlaps);          //overlaps checking
+  }
+  else {
+    // array of cells of one pitch, each holding a sample in its centre;
+    // the replicas are voxelised along their axis by the navigator
+    G4double cellSizeXY = 0.5*fPitch;
+    G4double arraySizeX = fNofSamplesX*cellSizeXY;
+    G4double arraySizeY = fNofSamplesY*cellSizeXY;
+    if (cellSizeXY < diamond_sizeXY
+        || arraySizeX > env_sizeXY || arraySizeY > env_sizeXY) {
+      G4ExceptionDescription msg;
+      msg << "The sample array of " << fNofSamplesX << " x " << fNofSamplesY
+          << " cells of pitch " << G4BestUnit(fPitch, "Length")
+          << " must hold a sample per cell and fit in the envelope.";
+      G4Exception("DetectorConstruction::Construct()", "MyCode0007",
+                  FatalException, msg);
+    }
+
+    auto solidArray
+      = new G4Box("SampleArray", arraySizeX, arraySizeY, diamond_sizeZ);
+    auto logicArray = new G4LogicalVolume(solidArray, env_mat, "SampleArray");
+    auto solidRow
+      = new G4Box("SampleRow", arraySizeX, cellSizeXY, diamond_sizeZ);
+    auto logicRow = new G4LogicalVolume(solidRow, env_mat, "SampleRow");
+    auto solidCell
+      = new G4Box("SampleCell", cellSizeXY, cellSizeXY, diamond_sizeZ);
+    auto logicCell = new G4LogicalVolume(solidCell, env_mat, "SampleCell");
+
+    new G4PVReplica("SampleRow", logicRow, logicArray, kYAxis,
+                    fNofSamplesY, fPitch);
+    new G4PVReplica("SampleCell", logicCell, logicRow, kXAxis,
+                    fNofSamplesX, fPitch);
+    new G4PVPlacement(0, G4ThreeVector(), logicShape, "Shape", logicCell,
+                      false, 0, checkOverlaps);
+    new G4PVPlacement(0, pos, logicArray, "SampleArray", logicEnv,
+                      false, 0, checkOverlaps);
+
+    // to the outer edges of the outer samples
+    halfSize.setX(arraySizeX - cellSizeXY + diamond_sizeXY);
+    halfSize.setY(arraySizeY - cellSizeXY + diamond_sizeXY);
+  }
+  fSamplesMin = pos - halfSize;
+  fSamplesMax = pos + halfSize;
 
 
   //
   // Shape 2
   //    
 
-  // Set Shape2 as scoring volume
+  // the scoring volume is the sample, or its layer, set above
   //
-  fScoringVolume = logicShape;
 
   //
   //always return the physical World
@@ -189,4 +271,259 @@ G4double Z = 6;
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
+void DetectorConstruction::ConstructSDandField()
+{
+  // the model registers itself with the region; one per thread, also when
+  // the geometry is rebuilt
+  static G4ThreadLocal VacuumTransportModel* vacuumTransport = nullptr;
+  if (!vacuumTransport) {
+    G4Region* envelopeRegion
+      = G4RegionStore::GetInstance()->GetRegion("EnvelopeRegion");
+    vacuumTransport
+      = new VacuumTransportModel("VacuumTransport", envelopeRegion);
+  }
+
+  // one detector per thread, owned by the SD manager; it is attached again
+  // to the scoring volume of a rebuilt geometry
+  static G4ThreadLocal DiamondSD* diamondSD = nullptr;
+  if (!diamondSD) {
+    diamondSD = new DiamondSD("DiamondSD", this);
+    G4SDManager::GetSDMpointer()->AddNewDetector(diamondSD);
+  }
+  SetSensitiveDetector(fScoringVolume, diamondSD);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4double DetectorConstruction::GetScoringMass() const
+{
+  // all copies share the logical volume
+  return fScoringVolume->GetMass() * GetNofCopies();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4int DetectorConstruction::GetCopyIndex(const G4VTouchable* touchable) const
+{
+  // depth 0 is the layer or the sample, followed by the cell and the row
+  G4int depth = 0, layer = 0;
+  if (fNofLayers > 1) {
+    layer = touchable->GetReplicaNumber(0);
+    depth = 1;
+  }
+  if (fNofSamplesX * fNofSamplesY == 1) return layer;
+
+  G4int x = touchable->GetReplicaNumber(depth + 1);
+  G4int y = touchable->GetReplicaNumber(depth + 2);
+  return layer + fNofLayers * (x + fNofSamplesX * y);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void DetectorConstruction::SetSamplesX(G4int n)
+{
+  fNofSamplesX = n;
+  GeometryChanged();
+}
+
+void DetectorConstruction::SetSamplesY(G4int n)
+{
+  fNofSamplesY = n;
+  GeometryChanged();
+}
+
+void DetectorConstruction::SetPitch(G4double pitch)
+{
+  fPitch = pitch;
+  GeometryChanged();
+}
+
+void DetectorConstruction::SetLayers(G4int n)
+{
+  fNofLayers = n;
+  GeometryChanged();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void DetectorConstruction::SetMaterial(const G4String& name)
+{
+  G4String previous = fMaterialName;
+  fMaterialName = name;
+  if (!BuildSampleMaterial()) {
+    G4ExceptionDescription msg;
+    msg << "Material " << name << " is neither defined nor a NIST material,"
+        << " the sample stays " << previous << ".";
+    G4Exception("DetectorConstruction::SetMaterial()", "MyCode0009",
+                JustWarning, msg);
+    fMaterialName = previous;
+    return;
+  }
+  MaterialChanged();
+}
+
+void DetectorConstruction::SetDensity(G4double density)
+{
+  fDensity = density;
+  MaterialChanged();
+}
+
+void DetectorConstruction::SetDopant(const G4String& symbol)
+{
+  if (symbol != "none"
+      && !G4NistManager::Instance()->FindOrBuildElement(symbol)) {
+    G4ExceptionDescription msg;
+    msg << "Element " << symbol << " is unknown, the dopant stays "
+        << fDopant << ".";
+    G4Exception("DetectorConstruction::SetDopant()", "MyCode0009",
+                JustWarning, msg);
+    return;
+  }
+  fDopant = symbol;
+  MaterialChanged();
+}
+
+void DetectorConstruction::SetDopantFraction(G4double fraction)
+{
+  fDopantFraction = fraction;
+  MaterialChanged();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4Material* DetectorConstruction::BuildSampleMaterial()
+{
+  // the base material: already defined, the built-in diamond or NIST
+  G4Material* base = G4Material::GetMaterial(fMaterialName, false);
+  if (!base && fMaterialName == "diamond") {
+    base = new G4Material("diamond", 6., 12.01*g/mole, 3.515*g/cm3);
+  }
+  if (!base) {
+    base = G4NistManager::Instance()->FindOrBuildMaterial(fMaterialName);
+  }
+  if (!base) return nullptr;
+
+  G4bool doped = (fDopant != "none" && fDopantFraction > 0.);
+  if (fDensity <= 0. && !doped) return base;
+
+  // derived materials are kept under their own name, so that a scan that
+  // comes back to a setting reuses the material and its couple
+  std::ostringstream name;
+  name << fMaterialName;
+  if (fDensity > 0.) name << "_" << fDensity/(g/cm3) << "gcm3";
+  if (doped) name << "_" << fDopant << fDopantFraction;
+  G4Material* material = G4Material::GetMaterial(name.str(), false);
+  if (material) return material;
+
+  G4double density = (fDensity > 0.) ? fDensity : base->GetDensity();
+  if (!doped) return new G4Material(name.str(), density, base);
+
+  material = new G4Material(name.str(), density, 2);
+  material->AddMaterial(base, 1. - fDopantFraction);
+  material->AddElement(G4NistManager::Instance()->FindOrBuildElement(fDopant),
+                       fDopantFraction);
+  return material;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void DetectorConstruction::GeometryChanged()
+{
+  // before the first initialisation the values are simply taken
+  if (G4StateManager::GetStateManager()->GetCurrentState() != G4State_Idle) {
+    return;
+  }
+  G4RunManager::GetRunManager()->ReinitializeGeometry(true);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void DetectorConstruction::MaterialChanged()
+{
+  // before the first initialisation Construct() takes the material
+  if (G4StateManager::GetStateManager()->GetCurrentState() != G4State_Idle) {
+    return;
+  }
+
+  // the volumes keep their solids and placements; the new material gets
+  // its own couple at the next run, the tables of the others are kept
+  G4Material* material = BuildSampleMaterial();
+  fSampleVolume->SetMaterial(material);
+  if (fScoringVolume != fSampleVolume) fScoringVolume->SetMaterial(material);
+  G4RunManager::GetRunManager()->PhysicsHasBeenModified();
+
+  G4cout << "Sample material: " << material->GetName() << ", "
+         << G4BestUnit(material->GetDensity(), "Volumic Mass") << G4endl;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void DetectorConstruction::DefineCommands()
+{
+  fMessenger = new G4GenericMessenger(this, "/b1/det/",
+                                      "Sample geometry");
+
+  fMessenger->DeclareMethod("samplesX", &DetectorConstruction::SetSamplesX,
+                            "Number of samples of the array along x.")
+    .SetParameterName("n", false)
+    .SetRange("n>=1")
+    .SetStates(G4State_PreInit, G4State_Idle)
+    .SetToBeBroadcasted(false);
+
+  fMessenger->DeclareMethod("samplesY", &DetectorConstruction::SetSamplesY,
+                            "Number of samples of the array along y.")
+    .SetParameterName("n", false)
+    .SetRange("n>=1")
+    .SetStates(G4State_PreInit, G4State_Idle)
+    .SetToBeBroadcasted(false);
+
+  fMessenger->DeclareMethodWithUnit("pitch", "nm",
+                                    &DetectorConstruction::SetPitch,
+                                    "Distance between the centres of two "
+                                    "neighbouring samples.")
+    .SetParameterName("pitch", false)
+    .SetRange("pitch>0.")
+    .SetStates(G4State_PreInit, G4State_Idle)
+    .SetToBeBroadcasted(false);
+
+  fMessenger->DeclareMethod("layers", &DetectorConstruction::SetLayers,
+                            "Number of layers of a sample along z.")
+    .SetParameterName("n", false)
+    .SetRange("n>=1")
+    .SetStates(G4State_PreInit, G4State_Idle)
+    .SetToBeBroadcasted(false);
+
+  fMessenger->DeclareMethod("material", &DetectorConstruction::SetMaterial,
+                            "Material of the samples: diamond, a NIST name"
+                            " or an already defined material.")
+    .SetParameterName("name", false)
+    .SetStates(G4State_PreInit, G4State_Idle)
+    .SetToBeBroadcasted(false);
+
+  fMessenger->DeclareMethodWithUnit("density", "g/cm3",
+                                    &DetectorConstruction::SetDensity,
+                                    "Density of the sample material,"
+                                    " 0 for the density of the material.")
+    .SetParameterName("density", false)
+    .SetRange("density>=0.")
+    .SetStates(G4State_PreInit, G4State_Idle)
+    .SetToBeBroadcasted(false);
+
+  fMessenger->DeclareMethod("dopant", &DetectorConstruction::SetDopant,
+                            "Element symbol of the dopant, or none.")
+    .SetParameterName("symbol", false)
+    .SetStates(G4State_PreInit, G4State_Idle)
+    .SetToBeBroadcasted(false);
+
+  fMessenger->DeclareMethod("dopantFraction",
+                            &DetectorConstruction::SetDopantFraction,
+                            "Mass fraction of the dopant.")
+    .SetParameterName("fraction", false)
+    .SetRange("fraction>=0. && fraction<1.")
+    .SetStates(G4State_PreInit, G4State_Idle)
+    .SetToBeBroadcasted(false);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
 }
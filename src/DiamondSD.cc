@@ -0,0 +1,123 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file DiamondSD.cc
+/// \brief Implementation of the B1::DiamondSD class
+
+#include "DiamondSD.hh"
+#include "DetectorConstruction.hh"
+
+#include "G4HCofThisEvent.hh"
+#include "G4ParticleDefinition.hh"
+#include "G4SDManager.hh"
+#include "G4Step.hh"
+#include "G4StepPoint.hh"
+#include "G4Track.hh"
+
+namespace B1
+{
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+DiamondSD::DiamondSD(const G4String& name,
+                     const DetectorConstruction* detector)
+: G4VSensitiveDetector(name),
+  fDetector(detector)
+{
+  collectionName.insert("Deposits");
+  collectionName.insert("Recoils");
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void DiamondSD::Initialize(G4HCofThisEvent* hce)
+{
+  // the collections are deleted with the event; their hits go back to the
+  // allocators of the thread, where the next event picks them up
+  fDepositHits
+    = new DiamondDepositHitsCollection(SensitiveDetectorName, collectionName[0]);
+  fRecoilHits
+    = new DiamondRecoilHitsCollection(SensitiveDetectorName, collectionName[1]);
+
+  if (fDepositsID < 0) {
+    auto sdManager = G4SDManager::GetSDMpointer();
+    fDepositsID = sdManager->GetCollectionID(fDepositHits);
+    fRecoilsID = sdManager->GetCollectionID(fRecoilHits);
+  }
+  hce->AddHitsCollection(fDepositsID, fDepositHits);
+  hce->AddHitsCollection(fRecoilsID, fRecoilHits);
+  fRecoilHit = nullptr;
+  fRecoilTrackID = -1;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool DiamondSD::ProcessHits(G4Step* step, G4TouchableHistory*)
+{
+  const G4Track* track = step->GetTrack();
+  G4double edep = step->GetTotalEnergyDeposit();
+  G4bool recoil = track->GetCurrentStepNumber() == 1
+                  && track->GetParentID() > 0
+                  && track->GetDefinition()->GetParticleName() == "C12";
+  G4bool recoilStep = recoil || track->GetTrackID() == fRecoilTrackID;
+  if (edep <= 0. && !recoilStep) return false;
+
+  G4int copy = (fDetector->GetNofCopies() > 1)
+    ? fDetector->GetCopyIndex(step->GetPreStepPoint()->GetTouchable()) : 0;
+
+  if (edep > 0.) {
+    if (copy >= G4int(fCopyHit.size())) fCopyHit.resize(copy + 1, -1);
+    G4int& index = fCopyHit[copy];
+    if (index < 0) {
+      index = G4int(fDepositHits->insert(new DiamondDepositHit(copy))) - 1;
+    }
+    (*fDepositHits)[index]->AddEdep(edep);
+  }
+
+  if (recoil) {
+    fRecoilHit = new DiamondRecoilHit(
+      track->GetTrackID(), track->GetParentID(), copy,
+      track->GetVertexPosition(), track->GetVertexKineticEnergy());
+    fRecoilHits->insert(fRecoilHit);
+    fRecoilTrackID = track->GetTrackID();
+  }
+  if (recoilStep) fRecoilHit->SetLength(track->GetTrackLength());
+  return true;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void DiamondSD::EndOfEvent(G4HCofThisEvent*)
+{
+  // reset only the copies of this event
+  for (std::size_t i = 0; i < fDepositHits->entries(); ++i) {
+    fCopyHit[(*fDepositHits)[i]->GetCopy()] = -1;
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+}
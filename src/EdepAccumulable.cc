@@ -0,0 +1,209 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file EdepAccumulable.cc
+/// \brief Implementation of the B1::EdepAccumulable class
+
+#include "EdepAccumulable.hh"
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <istream>
+#include <ostream>
+
+namespace B1
+{
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+EdepAccumulable::EdepAccumulable(const G4String& name,
+                                 G4double relativeAccuracy, G4double minValue)
+: G4VAccumulable(name),
+  fGamma((1. + relativeAccuracy) / (1. - relativeAccuracy)),
+  fLogGamma(std::log(fGamma)),
+  fMinValue(minValue)
+{}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4int EdepAccumulable::BucketIndex(G4double value) const
+{
+  return G4int(std::ceil(std::log(value) / fLogGamma));
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void EdepAccumulable::Fill(G4double value)
+{
+  fCount += 1.;
+  G4double delta = value - fMean;
+  fMean += delta / fCount;
+  fM2 += delta * (value - fMean);
+  if (fCount == 1.) {
+    fMin = value;
+    fMax = value;
+  }
+  else {
+    fMin = std::min(fMin, value);
+    fMax = std::max(fMax, value);
+  }
+
+  if (value < fMinValue) {
+    fLowCount += 1.;
+    return;
+  }
+
+  G4int index = BucketIndex(value);
+  if (fBuckets.empty()) {
+    fOffset = index;
+    fBuckets.assign(1, 0.);
+  }
+  else if (index < fOffset) {
+    fBuckets.insert(fBuckets.begin(), fOffset - index, 0.);
+    fOffset = index;
+  }
+  else if (index >= fOffset + G4int(fBuckets.size())) {
+    fBuckets.resize(index - fOffset + 1, 0.);
+  }
+  fBuckets[index - fOffset] += 1.;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void EdepAccumulable::Merge(const G4VAccumulable& other)
+{
+  const auto& rhs = static_cast<const EdepAccumulable&>(other);
+  if (rhs.fCount == 0.) return;
+
+  // pairwise combination of the moments (Chan et al.)
+  if (fCount == 0.) {
+    fMean = rhs.fMean;
+    fM2 = rhs.fM2;
+    fMin = rhs.fMin;
+    fMax = rhs.fMax;
+  }
+  else {
+    G4double count = fCount + rhs.fCount;
+    G4double delta = rhs.fMean - fMean;
+    fMean += delta * rhs.fCount / count;
+    fM2 += rhs.fM2 + delta * delta * fCount * rhs.fCount / count;
+    fMin = std::min(fMin, rhs.fMin);
+    fMax = std::max(fMax, rhs.fMax);
+  }
+  fCount += rhs.fCount;
+  fLowCount += rhs.fLowCount;
+
+  if (rhs.fBuckets.empty()) return;
+  if (fBuckets.empty()) {
+    fOffset = rhs.fOffset;
+    fBuckets = rhs.fBuckets;
+    return;
+  }
+  G4int first = std::min(fOffset, rhs.fOffset);
+  G4int last = std::max(fOffset + G4int(fBuckets.size()),
+                        rhs.fOffset + G4int(rhs.fBuckets.size()));
+  if (first < fOffset) {
+    fBuckets.insert(fBuckets.begin(), fOffset - first, 0.);
+    fOffset = first;
+  }
+  fBuckets.resize(last - fOffset, 0.);
+  for (std::size_t i = 0; i < rhs.fBuckets.size(); ++i) {
+    fBuckets[rhs.fOffset - fOffset + i] += rhs.fBuckets[i];
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void EdepAccumulable::Reset()
+{
+  fCount = 0.;
+  fMean = 0.;
+  fM2 = 0.;
+  fMin = 0.;
+  fMax = 0.;
+  fLowCount = 0.;
+  fOffset = 0;
+  fBuckets.clear();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void EdepAccumulable::Save(std::ostream& out) const
+{
+  out << std::setprecision(17)
+      << fCount << ' ' << fMean << ' ' << fM2 << ' ' << fMin << ' ' << fMax
+      << ' ' << fLowCount << ' ' << fOffset << ' ' << fBuckets.size();
+  for (auto count : fBuckets) out << ' ' << count;
+  out << '\n';
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool EdepAccumulable::Restore(std::istream& in)
+{
+  std::size_t nofBuckets = 0;
+  in >> fCount >> fMean >> fM2 >> fMin >> fMax >> fLowCount >> fOffset
+     >> nofBuckets;
+  if (!in) return false;
+  fBuckets.assign(nofBuckets, 0.);
+  for (auto& count : fBuckets) in >> count;
+  return bool(in);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4double EdepAccumulable::GetVariance() const
+{
+  return (fCount > 1.) ? fM2 / (fCount - 1.) : 0.;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4double EdepAccumulable::GetQuantile(G4double q) const
+{
+  if (fCount == 0.) return 0.;
+
+  q = std::min(std::max(q, 0.), 1.);
+  G4double rank = q * (fCount - 1.);
+  if (rank < fLowCount) return 0.;
+
+  G4double seen = fLowCount;
+  for (std::size_t i = 0; i < fBuckets.size(); ++i) {
+    seen += fBuckets[i];
+    if (seen > rank) {
+      // the value of the bucket with the smallest relative error; clamp to
+      // the exact extremes
+      G4double value = 2. * std::pow(fGamma, fOffset + G4int(i)) / (fGamma + 1.);
+      return std::min(std::max(value, fMin), fMax);
+    }
+  }
+  return fMax;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+}
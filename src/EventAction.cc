@@ -28,11 +28,14 @@
 /// \brief Implementation of the B1::EventAction class
 
 #include "EventAction.hh"
+#include "DiamondSD.hh"
 #include "RunAction.hh"
 #include <fstream>
 #include "G4Event.hh"
+#include "G4GenericMessenger.hh"
+#include "G4HCofThisEvent.hh"
 #include "G4RunManager.hh"
-#include "Analysis.hh"
+#include "G4SDManager.hh"
 namespace B1
 {
 
@@ -40,40 +43,149 @@ namespace B1
 
 EventAction::EventAction(RunAction* runAction)
 : fRunAction(runAction)
-{}
+{
+  DefineCommands();
+}
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
 EventAction::~EventAction()
-{}
+{
+  delete fMessenger;
+}
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
 void EventAction::BeginOfEventAction(const G4Event*)
 {
   fEdep = 0.;
+  fRecoils = 0;
+  fAncestry.Clear();
+  fRunAction->GetCascadeFinder().BeginOfEvent();
+  fRunAction->GetStatistics().BeginOfEvent();
 }
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
-void EventAction::EndOfEventAction(const G4Event*)
+void EventAction::EndOfEventAction(const G4Event* event)
 {
- auto analysisManager = G4AnalysisManager::Instance();
+ auto& output = fRunAction->GetOutput();
 
- analysisManager->FillH1(0, fEdep);
+ fRunAction->GetCascadeFinder().EndOfEvent(event->GetEventID(), output);
 
- analysisManager->FillNtupleDColumn(0, fEdep);
- analysisManager->AddNtupleRow();	
+ ProcessHits(event->GetHCofThisEvent());
+
+ output.FillH1(0, fEdep);
+
+ // an empty event is always counted; sparse mode skips its row
+ G4bool empty = (fEdep == 0. && fRecoils == 0);
+ if (empty) fRunAction->CountEmptyEvent();
+ if (!empty || !output.IsSparseEvents()) {
+   output.FillNtupleDColumn(0, fEdep);
+   output.AddNtupleRow();
+   fRunAction->GetStatistics().CountNtupleRow();
+ }
  //std::fstream dataFile;
  //dataFile.open("fEdep.txt",std::ios::app|std::ios::out);
  //dataFile<< fEdep << G4endl;
   // accumulate statistics in run action
  fRunAction->AddEdep(fEdep);
- G4cout << "fEdep: " << fEdep / CLHEP::MeV << " MeV" << G4endl;
+ fRunAction->GetPrecisionTarget().EndOfEvent(fEdep);
+ if (fVerbose > 0) G4cout << "fEdep: " << fEdep / CLHEP::MeV << " MeV" << G4endl;
+ fRunAction->GetStatistics().EndOfEvent();
+ fRunAction->GetCheckpoint().EndOfEvent();
+ fRunAction->GetSnapshot().EndOfEvent();
   
  
 }
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
+void EventAction::ProcessHits(G4HCofThisEvent* hce)
+{
+  if (!hce) return;
+
+  if (fDepositsID < 0) {
+    auto sdManager = G4SDManager::GetSDMpointer();
+    fDepositsID = sdManager->GetCollectionID("DiamondSD/Deposits");
+    fRecoilsID = sdManager->GetCollectionID("DiamondSD/Recoils");
+  }
+
+  auto& output = fRunAction->GetOutput();
+  const auto& histograms = fRunAction->GetHistograms();
+
+  // one hit per copy with a deposit
+  auto deposits
+    = static_cast<DiamondDepositHitsCollection*>(hce->GetHC(fDepositsID));
+  for (const auto hit : *deposits->GetVector()) {
+    fEdep += hit->GetEdep();
+    output.FillH1(histograms.GetCopyEdepId(), hit->GetCopy(), hit->GetEdep());
+  }
+
+  // one row of Mydata per recoil, at its vertex
+  auto& statistics = fRunAction->GetStatistics();
+  auto& precisionTarget = fRunAction->GetPrecisionTarget();
+  auto recoils
+    = static_cast<DiamondRecoilHitsCollection*>(hce->GetHC(fRecoilsID));
+  fRecoils = G4int(recoils->entries());
+  for (const auto hit : *recoils->GetVector()) {
+    output.FillH1(histograms.GetCopyRecoilsId(), hit->GetCopy());
+
+    // a PKA is a secondary of a primary, an SKA of a later generation
+    G4int parentGeneration = fAncestry.GetGeneration(hit->GetParentID());
+    if (parentGeneration < 0) continue;
+    G4bool pka = (parentGeneration == 0);
+    G4double energy = hit->GetEnergy();
+    G4double length = hit->GetLength();
+    const G4ThreeVector& position = hit->GetPosition();
+
+    if (pka) {
+      precisionTarget.CountPka(energy);
+      output.FillH1(histograms.GetPkaDepthId(),
+                    position.z() - histograms.GetFrontZ());
+    }
+    output.FillH1(pka ? 1 : 2, energy);
+    output.FillH1(pka ? 3 : 4, length);
+    output.FillH2(histograms.GetMapXYId(), position.x(), position.y());
+    output.FillH2(histograms.GetMapXZId(), position.x(), position.z());
+    output.FillH3(histograms.GetMapXYZId(),
+                  position.x(), position.y(), position.z());
+
+    output.FillNtupleDColumn(1, position.x());
+    output.FillNtupleDColumn(2, position.y());
+    output.FillNtupleDColumn(3, position.z());
+    output.FillNtupleDColumn(4, pka ? energy : 0.);
+    output.FillNtupleDColumn(5, pka ? 0. : energy);
+    output.FillNtupleDColumn(6, pka ? length : 0.);
+    output.FillNtupleDColumn(7, pka ? 0. : length);
+    output.FillNtupleIColumn(8, hit->GetTrackID());
+    output.FillNtupleIColumn(9, hit->GetCopy());
+    output.AddNtupleRow();
+    statistics.CountRecoil();
+    statistics.CountNtupleRow();
+
+    if (fVerbose > 1) {
+      G4cout << (pka ? "PKA" : "SKA") << " track " << hit->GetTrackID()
+             << ": " << energy / CLHEP::keV << " keV, "
+             << length / CLHEP::nm << " nm" << G4endl;
+    }
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void EventAction::DefineCommands()
+{
+  fMessenger = new G4GenericMessenger(this, "/b1/event/", "Event printout");
+
+  fMessenger->DeclareProperty("verbose", fVerbose,
+                              "0: nothing per event, 1: the energy deposit "
+                              "of every event, 2: also the positions and "
+                              "recoils of every step in the scoring volume.")
+    .SetParameterName("level", false)
+    .SetRange("level>=0 && level<=2");
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
 }
@@ -0,0 +1,192 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file HistogramIO.cc
+/// \brief Implementation of the B1::HistogramIO class
+
+#include "HistogramIO.hh"
+
+#include "G4AnalysisManager.hh"
+
+#include <iomanip>
+#include <istream>
+#include <ostream>
+
+namespace B1
+{
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool HistogramIO::H1Bins::Add(const H1Bins& other)
+{
+  if (other.nbins != nbins || other.lower != lower || other.upper != upper
+      || other.entries.size() != entries.size()) {
+    return false;
+  }
+  for (std::size_t bin = 0; bin < entries.size(); ++bin) {
+    entries[bin] += other.entries[bin];
+    sumW[bin] += other.sumW[bin];
+    sumW2[bin] += other.sumW2[bin];
+    sumXW[bin] += other.sumXW[bin];
+    sumX2W[bin] += other.sumX2W[bin];
+  }
+  return true;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+HistogramIO::H1Bins HistogramIO::GetH1(G4int id)
+{
+  H1Bins bins;
+  bins.id = id;
+  auto h1 = G4AnalysisManager::Instance()->GetH1(id, true, false);
+  if (!h1) return bins;
+
+  const auto& axis = h1->axis();
+  bins.nbins = axis.bins();
+  bins.lower = axis.lower_edge();
+  bins.upper = axis.upper_edge();
+  bins.entries = h1->bins_entries();
+  bins.sumW = h1->bins_sum_w();
+  bins.sumW2 = h1->bins_sum_w2();
+  for (const auto& sums : h1->bins_sum_xw()) bins.sumXW.push_back(sums[0]);
+  for (const auto& sums : h1->bins_sum_x2w()) bins.sumX2W.push_back(sums[0]);
+  return bins;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool HistogramIO::SetH1(const H1Bins& bins)
+{
+  auto h1 = G4AnalysisManager::Instance()->GetH1(bins.id, true, false);
+  if (!h1) return bins.nbins == 0;
+
+  const auto& axis = h1->axis();
+  if (h1->bins_entries().size() != bins.entries.size()
+      || axis.bins() != bins.nbins || axis.lower_edge() != bins.lower
+      || axis.upper_edge() != bins.upper) {
+    G4cerr << "HistogramIO: H1 " << bins.id << " was written with a "
+           << "different binning" << G4endl;
+    return false;
+  }
+
+  for (std::size_t bin = 0; bin < bins.entries.size(); ++bin) {
+    h1->set_bin_content(bin, bins.entries[bin], bins.sumW[bin],
+                        bins.sumW2[bin], bins.sumXW[bin], bins.sumX2W[bin]);
+  }
+  return true;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void HistogramIO::Write(std::ostream& out, const H1Bins& bins)
+{
+  out << std::setprecision(17)
+      << "h1 " << bins.id << ' ' << bins.entries.size();
+  if (bins.entries.empty()) {
+    out << '\n';
+    return;
+  }
+
+  out << ' ' << bins.nbins << ' ' << bins.lower << ' ' << bins.upper << '\n';
+  for (std::size_t bin = 0; bin < bins.entries.size(); ++bin) {
+    out << bins.entries[bin] << ' ' << bins.sumW[bin] << ' '
+        << bins.sumW2[bin] << ' ' << bins.sumXW[bin] << ' '
+        << bins.sumX2W[bin] << '\n';
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool HistogramIO::Read(std::istream& in, H1Bins& bins)
+{
+  std::string tag;
+  G4int id = -1;
+  std::size_t nofBins = 0;
+  in >> tag >> id >> nofBins;
+  if (!in || tag != "h1") return false;
+
+  bins = H1Bins();
+  bins.id = id;
+  if (nofBins == 0) return true;
+
+  in >> bins.nbins >> bins.lower >> bins.upper;
+  bins.entries.resize(nofBins);
+  bins.sumW.resize(nofBins);
+  bins.sumW2.resize(nofBins);
+  bins.sumXW.resize(nofBins);
+  bins.sumX2W.resize(nofBins);
+  for (std::size_t bin = 0; bin < nofBins; ++bin) {
+    in >> bins.entries[bin] >> bins.sumW[bin] >> bins.sumW2[bin]
+       >> bins.sumXW[bin] >> bins.sumX2W[bin];
+  }
+  return bool(in);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void HistogramIO::WriteH1(std::ostream& out, G4int id)
+{
+  Write(out, GetH1(id));
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool HistogramIO::ReadH1(std::istream& in, G4int id)
+{
+  H1Bins bins;
+  return Read(in, bins) && bins.id == id && SetH1(bins);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void HistogramIO::WriteAll(std::ostream& out)
+{
+  G4int nofH1s = G4AnalysisManager::Instance()->GetNofH1s();
+  out << "histograms " << nofH1s << '\n';
+  for (G4int id = 0; id < nofH1s; ++id) WriteH1(out, id);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool HistogramIO::ReadAll(std::istream& in)
+{
+  std::string tag;
+  G4int nofH1s = -1;
+  in >> tag >> nofH1s;
+  if (!in || tag != "histograms"
+      || nofH1s != G4AnalysisManager::Instance()->GetNofH1s()) {
+    return false;
+  }
+  for (G4int id = 0; id < nofH1s; ++id) {
+    if (!ReadH1(in, id)) return false;
+  }
+  return true;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+}
@@ -0,0 +1,257 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file HistogramSet.cc
+/// \brief Implementation of the B1::HistogramSet class
+
+#include "HistogramSet.hh"
+#include "DetectorConstruction.hh"
+#include "OutputWriter.hh"
+
+#include "G4AccumulableManager.hh"
+#include "G4AnalysisManager.hh"
+#include "G4GenericMessenger.hh"
+#include "G4SystemOfUnits.hh"
+
+#include <cmath>
+#include <istream>
+#include <ostream>
+
+namespace B1
+{
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+HistogramSet::HistogramSet()
+{
+  fSpecs = {
+    { "fEdep",      "Edep",       200, 0., 5*MeV,   1*eV,     10*GeV },
+    { "PKA_E",      "PKA_E",      200, 0., 300*keV, 1*eV,     10*GeV },
+    { "SKA_E",      "SKA_E",      200, 0., 300*keV, 1*eV,     10*GeV },
+    { "PKA_length", "PKA_length", 200, 0., 400*nm,  0.001*nm, 1*mm },
+    { "SKA_length", "SKA_length", 200, 0., 400*nm,  0.001*nm, 1*mm }
+  };
+
+  DefineCommands();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+HistogramSet::~HistogramSet()
+{
+  delete fMessenger;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void HistogramSet::Book()
+{
+  auto analysisManager = G4AnalysisManager::Instance();
+  G4AccumulableManager* accumulableManager = G4AccumulableManager::Instance();
+
+  for (const auto& spec : fSpecs) {
+    analysisManager->CreateH1(spec.name, spec.title, spec.nbins, spec.min, spec.max);
+
+    fAutoHistograms.emplace_back(
+      new LogHistogram(spec.name + "_auto", fBinsPerDecade, fMaxBins));
+    accumulableManager->RegisterAccumulable(fAutoHistograms.back().get());
+  }
+
+  // rebinned to the number of copies at the begin of each run
+  fCopyEdepId = analysisManager->CreateH1(
+    "copy_Edep", "Energy deposit per copy", 1, -0.5, 0.5);
+  fCopyRecoilsId = analysisManager->CreateH1(
+    "copy_Recoils", "Recoils per copy", 1, -0.5, 0.5);
+
+  // rebinned to the samples at the begin of each run
+  fPkaDepthId = analysisManager->CreateH1(
+    "PKA_depth", "Depth of the PKA vertex", 1, 0., 1.);
+  fMapXYId = analysisManager->CreateH2(
+    "pos_xy", "Recoil positions x-y", 1, 0., 1., 1, 0., 1.);
+  fMapXZId = analysisManager->CreateH2(
+    "pos_xz", "Recoil positions x-z", 1, 0., 1., 1, 0., 1.);
+  fMapXYZId = analysisManager->CreateH3(
+    "pos_xyz", "Recoil positions", 1, 0., 1., 1, 0., 1., 1, 0., 1.);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void HistogramSet::BeginOfRun(OutputWriter& output,
+                              const DetectorConstruction& detector)
+{
+  auto analysisManager = G4AnalysisManager::Instance();
+  G4bool autoRange = (fMode == "auto");
+
+  for (std::size_t id = 0; id < fSpecs.size(); ++id) {
+    const auto& spec = fSpecs[id];
+    if (fMode == "fixed") {
+      analysisManager->SetH1(id, spec.nbins, spec.min, spec.max);
+    }
+    else {
+      // also the starting point of the auto mode, whose edges the master
+      // replaced at the end of the previous run
+      G4int nbins = G4int(std::ceil(
+        fBinsPerDecade * std::log10(spec.logMax / spec.logMin)));
+      analysisManager->SetH1(id, nbins, spec.logMin, spec.logMax,
+                             "none", "none", "log");
+    }
+
+    // the configuration is taken at Reset()
+    fAutoHistograms[id]->Configure(fBinsPerDecade, fMaxBins);
+    fAutoHistograms[id]->Reset();
+    output.SetH1Sink(id, autoRange ? fAutoHistograms[id].get() : nullptr);
+  }
+
+  G4int nofCopies = detector.GetNofCopies();
+  analysisManager->SetH1(fCopyEdepId, nofCopies, -0.5, nofCopies - 0.5);
+  analysisManager->SetH1(fCopyRecoilsId, nofCopies, -0.5, nofCopies - 0.5);
+
+  const G4ThreeVector& min = detector.GetSamplesMin();
+  const G4ThreeVector& max = detector.GetSamplesMax();
+  fFrontZ = min.z();
+  analysisManager->SetH1(fPkaDepthId, fMapBins, 0., max.z() - min.z());
+  analysisManager->SetH2(fMapXYId, fMapBins, min.x(), max.x(),
+                         fMapBins, min.y(), max.y());
+  analysisManager->SetH2(fMapXZId, fMapBins, min.x(), max.x(),
+                         fMapBins, min.z(), max.z());
+  analysisManager->SetH3(fMapXYZId, fMapBins3D, min.x(), max.x(),
+                         fMapBins3D, min.y(), max.y(),
+                         fMapBins3D, min.z(), max.z());
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void HistogramSet::EndOfRun(G4bool isMaster)
+{
+  // the accumulables are merged; only the master histograms are rebooked,
+  // the worker ones stay empty in this mode
+  if (fMode != "auto" || !isMaster) return;
+
+  auto analysisManager = G4AnalysisManager::Instance();
+  for (std::size_t id = 0; id < fSpecs.size(); ++id) {
+    const auto& histogram = *fAutoHistograms[id];
+    if (histogram.GetNbins() == 0) continue;
+
+    std::vector<G4double> edges = histogram.GetEdges();
+    analysisManager->SetH1(id, edges);
+    for (G4int bin = 0; bin < histogram.GetNbins(); ++bin) {
+      G4double content = histogram.GetBinContent(bin);
+      if (content == 0.) continue;
+      G4double center = std::sqrt(edges[bin] * edges[bin + 1]);
+      analysisManager->FillH1(id, center, content);
+    }
+    if (histogram.GetUnderflow() > 0.) {
+      analysisManager->FillH1(id, 0., histogram.GetUnderflow());
+    }
+
+    G4cout << " " << fSpecs[id].name << ": " << histogram.GetNbins()
+           << " auto-ranged bins from " << edges.front()
+           << " to " << edges.back() << G4endl;
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+std::vector<const LogHistogram*> HistogramSet::GetAutoHistograms() const
+{
+  std::vector<const LogHistogram*> histograms;
+  if (fMode != "auto") return histograms;
+  for (const auto& histogram : fAutoHistograms) {
+    histograms.push_back(histogram.get());
+  }
+  return histograms;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void HistogramSet::Save(std::ostream& out) const
+{
+  out << "logHistograms " << fAutoHistograms.size() << '\n';
+  for (const auto& histogram : fAutoHistograms) histogram->Save(out);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool HistogramSet::Restore(std::istream& in)
+{
+  std::string tag;
+  std::size_t nofHistograms = 0;
+  in >> tag >> nofHistograms;
+  if (!in || tag != "logHistograms" || nofHistograms != fAutoHistograms.size()) {
+    return false;
+  }
+  for (auto& histogram : fAutoHistograms) {
+    if (!histogram->Restore(in)) return false;
+  }
+  return true;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void HistogramSet::DefineCommands()
+{
+  fMessenger = new G4GenericMessenger(this, "/b1/histo/",
+                                      "Binning of the histograms");
+
+  fMessenger->DeclareProperty("mode", fMode,
+                              "fixed: original linear ranges, "
+                              "log: logarithmic bins over a wide range, "
+                              "auto: logarithmic bins over the range of "
+                              "the data.")
+    .SetParameterName("mode", false)
+    .SetCandidates("fixed log auto")
+    .SetStates(G4State_PreInit, G4State_Idle);
+
+  fMessenger->DeclareProperty("binsPerDecade", fBinsPerDecade,
+                              "Number of bins per decade in log and auto mode.")
+    .SetParameterName("bins", false)
+    .SetRange("bins>0")
+    .SetStates(G4State_PreInit, G4State_Idle);
+
+  fMessenger->DeclareProperty("maxBins", fMaxBins,
+                              "Maximum number of bins in auto mode; a wider "
+                              "range merges pairs of bins.")
+    .SetParameterName("bins", false)
+    .SetRange("bins>=2")
+    .SetStates(G4State_PreInit, G4State_Idle);
+
+  fMessenger->DeclareProperty("mapBins", fMapBins,
+                              "Bins per axis of the depth profile and of the "
+                              "2D position maps.")
+    .SetParameterName("bins", false)
+    .SetRange("bins>=1")
+    .SetStates(G4State_PreInit, G4State_Idle);
+
+  fMessenger->DeclareProperty("mapBins3D", fMapBins3D,
+                              "Bins per axis of the 3D position map.")
+    .SetParameterName("bins", false)
+    .SetRange("bins>=1")
+    .SetStates(G4State_PreInit, G4State_Idle);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+}
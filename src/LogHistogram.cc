@@ -0,0 +1,216 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file LogHistogram.cc
+/// \brief Implementation of the B1::LogHistogram class
+
+#include "LogHistogram.hh"
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <istream>
+#include <ostream>
+
+namespace B1
+{
+
+namespace
+{
+  // floor(a/2) also for negative grid indices
+  G4int HalfDown(G4int a) { return (a >= 0) ? a / 2 : -((1 - a) / 2); }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+LogHistogram::LogHistogram(const G4String& name, G4double binsPerDecade,
+                           G4int maxBins)
+: G4VAccumulable(name),
+  fBinsPerDecade(binsPerDecade),
+  fMaxBins(maxBins),
+  fNextBinsPerDecade(binsPerDecade),
+  fNextMaxBins(maxBins)
+{}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void LogHistogram::Configure(G4double binsPerDecade, G4int maxBins)
+{
+  fNextBinsPerDecade = binsPerDecade;
+  fNextMaxBins = (maxBins > 1) ? maxBins : 2;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4double LogHistogram::BinWidth() const
+{
+  return std::ldexp(1., fLevel) / fBinsPerDecade;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4int LogHistogram::Index(G4double value) const
+{
+  return G4int(std::floor(std::log10(value) / BinWidth()));
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void LogHistogram::Fill(G4double value, G4double weight)
+{
+  if (!(value > 0.)) {
+    fUnderflow += weight;
+    return;
+  }
+
+  G4int index = Index(value);
+  G4int size = G4int(fContents.size());
+  if (size > 0 && index >= fOffset && index < fOffset + size) {
+    fContents[index - fOffset] += weight;
+    return;
+  }
+  Add(index, { weight });
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void LogHistogram::Add(G4int offset, const std::vector<G4double>& contents)
+{
+  if (contents.empty()) return;
+
+  if (fContents.empty()) {
+    fOffset = offset;
+    fContents = contents;
+  }
+  else {
+    G4int first = std::min(fOffset, offset);
+    G4int last = std::max(fOffset + G4int(fContents.size()),
+                          offset + G4int(contents.size()));
+    if (first < fOffset) {
+      fContents.insert(fContents.begin(), fOffset - first, 0.);
+      fOffset = first;
+    }
+    fContents.resize(last - fOffset, 0.);
+    for (std::size_t i = 0; i < contents.size(); ++i) {
+      fContents[offset - fOffset + i] += contents[i];
+    }
+  }
+
+  while (G4int(fContents.size()) > fMaxBins) Coarsen();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void LogHistogram::Coarsen()
+{
+  G4int offset = HalfDown(fOffset);
+  G4int last = HalfDown(fOffset + G4int(fContents.size()) - 1);
+  std::vector<G4double> contents(last - offset + 1, 0.);
+  for (std::size_t i = 0; i < fContents.size(); ++i) {
+    contents[HalfDown(fOffset + G4int(i)) - offset] += fContents[i];
+  }
+  fOffset = offset;
+  fContents.swap(contents);
+  ++fLevel;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void LogHistogram::Merge(const G4VAccumulable& other)
+{
+  const auto& rhs = static_cast<const LogHistogram&>(other);
+  fUnderflow += rhs.fUnderflow;
+  if (rhs.fContents.empty()) return;
+
+  // bring both to the coarser grid
+  LogHistogram copy(rhs);
+  while (fLevel < copy.fLevel) Coarsen();
+  while (copy.fLevel < fLevel) copy.Coarsen();
+  Add(copy.fOffset, copy.fContents);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void LogHistogram::Reset()
+{
+  fBinsPerDecade = fNextBinsPerDecade;
+  fMaxBins = fNextMaxBins;
+  fLevel = 0;
+  fUnderflow = 0.;
+  fOffset = 0;
+  fContents.clear();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void LogHistogram::Save(std::ostream& out) const
+{
+  out << std::setprecision(17)
+      << fBinsPerDecade << ' ' << fMaxBins << ' ' << fLevel << ' '
+      << fUnderflow << ' ' << fOffset << ' ' << fContents.size();
+  for (auto content : fContents) out << ' ' << content;
+  out << '\n';
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool LogHistogram::Restore(std::istream& in)
+{
+  std::size_t nofBins = 0;
+  in >> fBinsPerDecade >> fMaxBins >> fLevel >> fUnderflow >> fOffset
+     >> nofBins;
+  if (!in) return false;
+  fContents.assign(nofBins, 0.);
+  for (auto& content : fContents) in >> content;
+  return bool(in);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4double LogHistogram::GetEntries() const
+{
+  G4double entries = fUnderflow;
+  for (auto content : fContents) entries += content;
+  return entries;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+std::vector<G4double> LogHistogram::GetEdges() const
+{
+  std::vector<G4double> edges;
+  if (fContents.empty()) return edges;
+
+  G4double width = BinWidth();
+  for (std::size_t i = 0; i <= fContents.size(); ++i) {
+    edges.push_back(std::pow(10., (fOffset + G4int(i)) * width));
+  }
+  return edges;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+}
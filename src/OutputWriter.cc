@@ -0,0 +1,657 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file OutputWriter.cc
+/// \brief Implementation of the B1::OutputWriter class
+
+#include "OutputWriter.hh"
+
+#include "G4AutoLock.hh"
+#include "G4GenericMessenger.hh"
+#include "G4Threading.hh"
+
+#include <algorithm>
+#include <fstream>
+#include <tuple>
+#include <vector>
+
+namespace
+{
+  // ntuple files of the workers in the current run, for the manifest
+  struct WorkerFile
+  {
+    G4int thread;
+    G4String kind;   // "ntuples": analysis manager file, "rows": csv rows
+    G4String name;
+    bool operator<(const WorkerFile& other) const
+    {
+      return std::tie(thread, kind, name)
+             < std::tie(other.thread, other.kind, other.name);
+    }
+  };
+  std::vector<WorkerFile> workerFiles;
+  G4Mutex workerFilesMutex = G4MUTEX_INITIALIZER;
+
+  // <file>[.<ext>] without the extension
+  G4String StripExtension(const G4String& fileName)
+  {
+    auto slash = fileName.rfind('/');
+    auto dot = fileName.rfind('.');
+    if (dot != G4String::npos && (slash == G4String::npos || dot > slash)) {
+      return fileName.substr(0, dot);
+    }
+    return fileName;
+  }
+}
+
+namespace B1
+{
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+OutputWriter::OutputWriter()
+: fAnalysisManager(G4AnalysisManager::Instance())
+{
+  DefineCommands();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+OutputWriter::~OutputWriter()
+{
+  EndOfRun();
+  StopWriter();
+  delete fMessenger;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4int OutputWriter::CreateNtuple(const G4String& name, const G4String& title)
+{
+  G4int id = fAnalysisManager->CreateNtuple(name, title);
+  if (fNtupleBook.empty()) fFirstNtupleId = id;
+  fNtupleBook.push_back({ name, title, {}, {}, {} });
+  return id;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4int OutputWriter::CreateNtupleDColumn(const G4String& name)
+{
+  auto& ntuple = fNtupleBook.back();
+  ntuple.columns.push_back(name);
+  ntuple.isInt.push_back(false);
+  ntuple.row.push_back(0.);
+  return fAnalysisManager->CreateNtupleDColumn(name);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4int OutputWriter::CreateNtupleIColumn(const G4String& name)
+{
+  auto& ntuple = fNtupleBook.back();
+  ntuple.columns.push_back(name);
+  ntuple.isInt.push_back(true);
+  ntuple.row.push_back(0.);
+  return fAnalysisManager->CreateNtupleIColumn(name);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void OutputWriter::FinishNtuple()
+{
+  fAnalysisManager->FinishNtuple();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void OutputWriter::BeginOfRun()
+{
+  OpenFile();
+  fStalls = 0;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void OutputWriter::StartWriter()
+{
+  if (!fAsync || fNtuplesOff || fNtupleBook.empty() || fRunning) return;
+  // the master of a multi-threaded run fills no rows
+  if (G4Threading::IsMultithreadedApplication()
+      && G4Threading::IsMasterThread()) return;
+
+  // the pool is rebuilt only when its size was changed between runs
+  std::size_t rowsPerBlock = std::max(fBatchSize, 1);
+  std::size_t nofBlocks
+    = std::max<std::size_t>(std::size_t(fQueueSize) / rowsPerBlock, 2);
+  if (fWriter.joinable()
+      && (rowsPerBlock != fRowsPerBlock || nofBlocks != fBlocks.size())) {
+    StopWriter();
+  }
+  if (!fWriter.joinable()) {
+    std::size_t nofColumns = 0;
+    for (const auto& ntuple : fNtupleBook) {
+      nofColumns = std::max(nofColumns, ntuple.columns.size());
+    }
+    fRowsPerBlock = rowsPerBlock;
+    fBlocks.assign(nofBlocks, Block());
+    fFull = std::make_unique<SpscQueue<Block*>>(nofBlocks);
+    fFree = std::make_unique<SpscQueue<Block*>>(nofBlocks);
+    for (auto& block : fBlocks) {
+      block.ntuples.reserve(rowsPerBlock);
+      block.values.reserve(rowsPerBlock * nofColumns);
+      fFree->Push(&block);
+    }
+    fCurrent = nullptr;
+    fRequested = 0;
+    fAcknowledged = 0;
+    fQuit = false;
+    fWriter = std::thread(&OutputWriter::WriterLoop, this);
+  }
+
+  // the names are read by the writer only for the requests of this run
+  fRowFileNames.clear();
+  for (const auto& ntuple : fNtupleBook) {
+    fRowFileNames.push_back(RowFileName(ntuple));
+  }
+  for (auto& ntuple : fNtupleBook) {
+    std::fill(ntuple.row.begin(), ntuple.row.end(), 0.);
+  }
+  fRunning = true;
+  SendRequest(Block::kOpen);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void OutputWriter::EndOfRun()
+{
+  if (!fRunning) return;
+
+  // the writer closes the files after the last rows; nothing waits for it
+  SendRequest(Block::kClose);
+  fRunning = false;
+
+  if (fStalls > 0) {
+    G4cout
+      << "OutputWriter [thread " << G4Threading::G4GetThreadId() << "]: "
+      << fStalls << " blocks waited for the writer; "
+      << fBlocks.size() << " blocks of " << fRowsPerBlock << " rows "
+      << "(/b1/output/queueSize, /b1/output/batchSize)" << G4endl;
+  }
+  if (G4int errors = fWriteErrors.exchange(0)) {
+    G4ExceptionDescription msg;
+    msg << errors << " csv row files could not be written or renamed.";
+    G4Exception("OutputWriter::EndOfRun()", "MyCode0008", JustWarning, msg);
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void OutputWriter::OpenFile()
+{
+  fNtuplesOff = (fFormat == "none") || !fNtuples;
+  if (fFormat == "none") return;
+
+  // inactive ntuples are neither filled nor written; the asynchronous
+  // rows go to the csv files of the writer instead
+  fAnalysisManager->SetActivation(true);
+  fAnalysisManager->SetNtupleActivation(fNtuples && !fAsync);
+
+  // the analysis manager takes the merging mode when the first file is
+  // opened; it cannot be changed afterwards
+  if (fMergeApplied < 0) {
+    fAnalysisManager->SetNtupleMerging(fMergeNtuples);
+    fMergeApplied = fMergeNtuples;
+  }
+  else if (fMergeApplied != G4int(fMergeNtuples)
+           && G4Threading::IsMasterThread()) {
+    G4ExceptionDescription msg;
+    msg << "/b1/output/mergeNtuples only takes effect before the first run; "
+        << "the ntuples are still " << (fMergeApplied ? "" : "not ")
+        << "merged.";
+    G4Exception("OutputWriter::OpenFile()", "MyCode0008", JustWarning, msg);
+  }
+
+  if (G4Threading::IsMasterThread()) {
+    // the master opens its file before the workers are started
+    G4AutoLock lock(&workerFilesMutex);
+    workerFiles.clear();
+  }
+
+  // the extension of the file name follows the format
+  fAnalysisManager->SetDefaultFileType(fFormat);
+  if (fBasketSize > 0) fAnalysisManager->SetBasketSize(fBasketSize);
+  if (fBasketEntries > 0) fAnalysisManager->SetBasketEntries(fBasketEntries);
+  if (fCompression >= 0) fAnalysisManager->SetCompressionLevel(fCompression);
+  fAnalysisManager->OpenFile(fFileName);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void OutputWriter::WriteFile()
+{
+  if (!fAnalysisManager->IsOpenFile()) return;
+  fAnalysisManager->Write();
+  fAnalysisManager->CloseFile();
+
+  if (!G4Threading::IsMultithreadedApplication()) return;
+  if (G4Threading::IsWorkerThread()) {
+    G4AutoLock lock(&workerFilesMutex);
+    G4int thread = G4Threading::G4GetThreadId();
+    if (fMergeApplied == 0 && fNtuples && !fAsync) {
+      workerFiles.push_back({ thread, "ntuples", DiskFileName() });
+    }
+    for (const auto& name : fRowFileNames) {
+      workerFiles.push_back({ thread, "rows", name });
+    }
+    fRowFileNames.clear();
+  }
+  else if (fMergeApplied == 0 || fAsync) {
+    // the workers have closed their files before the master ends the run
+    WriteManifest();
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4String OutputWriter::DiskFileName() const
+{
+  // as named by the analysis manager: <file>[_t<thread>].<ext>
+  G4String name = fFileName;
+  G4String extension = fFormat;
+  auto slash = name.rfind('/');
+  auto dot = name.rfind('.');
+  if (dot != G4String::npos && (slash == G4String::npos || dot > slash)) {
+    extension = name.substr(dot + 1);
+    name = name.substr(0, dot);
+  }
+  if (G4Threading::IsWorkerThread()) {
+    name += "_t" + std::to_string(G4Threading::G4GetThreadId());
+  }
+  return name + "." + extension;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void OutputWriter::WriteManifest() const
+{
+  G4AutoLock lock(&workerFilesMutex);
+  auto files = workerFiles;
+  lock.unlock();
+  std::sort(files.begin(), files.end());
+
+  // the paths are relative to the directory of the manifest
+  auto baseName = [](const G4String& path) -> G4String {
+    auto slash = path.rfind('/');
+    return (slash == G4String::npos) ? path : G4String(path.substr(slash + 1));
+  };
+
+  G4String diskName = DiskFileName();
+  G4String manifestName = diskName.substr(0, diskName.rfind('.')) + ".manifest";
+  std::ofstream out(manifestName);
+  out << "# B1 output manifest: the files of one run, one data set\n"
+      << "format " << fFormat << '\n'
+      << "histograms " << baseName(diskName) << '\n';
+  for (const auto& file : files) {
+    out << file.kind << ' ' << baseName(file.name) << " thread " << file.thread
+        << '\n';
+  }
+  if (!out) {
+    G4ExceptionDescription msg;
+    msg << "The manifest " << manifestName << " cannot be written.";
+    G4Exception("OutputWriter::WriteManifest()", "MyCode0008", JustWarning, msg);
+    return;
+  }
+  G4cout << "OutputWriter: " << files.size() << " ntuple files listed in "
+         << manifestName << G4endl;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void OutputWriter::Flush()
+{
+  if (!fRunning) return;
+  SendRequest(Block::kFlush);
+  WaitForWriter();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void OutputWriter::RotateRows(G4int segment)
+{
+  if (!fRunning) return;
+  SendRequest(Block::kRotate, segment);
+  WaitForWriter();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void OutputWriter::SetH1Sink(G4int id, LogHistogram* sink)
+{
+  if (id >= G4int(fH1Sinks.size())) {
+    if (!sink) return;
+    fH1Sinks.resize(id + 1, nullptr);
+  }
+  fH1Sinks[id] = sink;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void OutputWriter::AddRow(std::size_t index)
+{
+  auto& row = fNtupleBook[index].row;
+  if (!fCurrent) fCurrent = TakeBlock();
+  fCurrent->ntuples.push_back(G4int(index));
+  fCurrent->values.insert(fCurrent->values.end(), row.begin(), row.end());
+  // as the analysis manager, start the next row from zero
+  std::fill(row.begin(), row.end(), 0.);
+
+  if (fCurrent->ntuples.size() >= fRowsPerBlock) {
+    Send(fCurrent);
+    fCurrent = nullptr;
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+OutputWriter::Block* OutputWriter::TakeBlock()
+{
+  Block* block = nullptr;
+  if (fFree->Pop(&block, 1) == 0) {
+    // all blocks are queued: wait for the writer
+    ++fStalls;
+    while (fFree->Pop(&block, 1) == 0) std::this_thread::yield();
+  }
+  block->kind = Block::kRows;
+  block->ntuples.clear();
+  block->values.clear();
+  return block;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void OutputWriter::Send(Block* block)
+{
+  // the queue holds every block of the pool, so the push cannot fail
+  fFull->Push(block);
+
+  // the writer tests the queue with the mutex held before it sleeps
+  { std::lock_guard<std::mutex> lock(fMutex); }
+  fWake.notify_one();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void OutputWriter::SendRequest(Block::Kind kind, G4int segment)
+{
+  // the rows filled so far go first
+  if (fCurrent) {
+    Send(fCurrent);
+    fCurrent = nullptr;
+  }
+  Block* block = TakeBlock();
+  block->kind = kind;
+  block->segment = segment;
+  if (kind == Block::kFlush || kind == Block::kRotate) ++fRequested;
+  Send(block);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void OutputWriter::WaitForWriter()
+{
+  std::unique_lock<std::mutex> lock(fMutex);
+  fDone.wait(lock, [this]() { return fAcknowledged >= fRequested; });
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void OutputWriter::StopWriter()
+{
+  if (!fWriter.joinable()) return;
+
+  // the writer empties the queue before it returns
+  {
+    std::lock_guard<std::mutex> lock(fMutex);
+    fQuit = true;
+  }
+  fWake.notify_one();
+  fWriter.join();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void OutputWriter::WriterLoop()
+{
+  // This thread never calls Geant4; it owns the csv files and writes the
+  // blocks in their order.
+  while (true) {
+    {
+      std::unique_lock<std::mutex> lock(fMutex);
+      fWake.wait(lock, [this]() { return !fFull->Empty() || fQuit; });
+      if (fFull->Empty()) break;
+    }
+    Block* block = nullptr;
+    while (fFull->Pop(&block, 1) == 1) {
+      WriteBlock(*block);
+      G4bool request = block->kind == Block::kFlush
+                       || block->kind == Block::kRotate;
+      fFree->Push(block);
+      if (request) {
+        {
+          std::lock_guard<std::mutex> lock(fMutex);
+          ++fAcknowledged;
+        }
+        fDone.notify_all();
+      }
+    }
+  }
+  CloseRowFiles();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void OutputWriter::WriteBlock(const Block& block)
+{
+  switch (block.kind) {
+    case Block::kOpen:
+      OpenRowFiles();
+      return;
+    case Block::kClose:
+      CloseRowFiles();
+      return;
+    case Block::kFlush:
+      for (auto file : fRowFiles) {
+        if (file && std::fflush(file) != 0) ++fWriteErrors;
+      }
+      return;
+    case Block::kRotate:
+      CloseRowFiles();
+      for (const auto& name : fRowFileNames) {
+        G4String base = StripExtension(name);
+        G4String segmentName
+          = base + "_seg" + std::to_string(block.segment) + ".csv";
+        if (std::rename(name.c_str(), segmentName.c_str()) != 0) ++fWriteErrors;
+      }
+      OpenRowFiles();
+      return;
+    case Block::kRows:
+      break;
+  }
+
+  const G4double* values = block.values.data();
+  for (auto index : block.ntuples) {
+    const auto& ntuple = fNtupleBook[index];
+    std::size_t nofColumns = ntuple.columns.size();
+    if (std::FILE* file = fRowFiles[index]) {
+      for (std::size_t column = 0; column < nofColumns; ++column) {
+        if (column > 0) std::fputc(',', file);
+        if (ntuple.isInt[column]) std::fprintf(file, "%d", G4int(values[column]));
+        else std::fprintf(file, "%.17g", values[column]);
+      }
+      std::fputc('\n', file);
+    }
+    values += nofColumns;
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void OutputWriter::OpenRowFiles()
+{
+  CloseRowFiles();
+  for (std::size_t index = 0; index < fNtupleBook.size(); ++index) {
+    const auto& ntuple = fNtupleBook[index];
+    std::FILE* file = std::fopen(fRowFileNames[index].c_str(), "w");
+    fRowFiles.push_back(file);
+    if (!file) {
+      ++fWriteErrors;
+      continue;
+    }
+    std::setvbuf(file, nullptr, _IOFBF, 1 << 16);
+
+    // the commented header of the Geant4 csv ntuples
+    std::fprintf(file, "#class tools::wcsv::ntuple\n#title %s\n"
+                 "#separator 44\n#vector_separator 59\n", ntuple.title.c_str());
+    for (std::size_t column = 0; column < ntuple.columns.size(); ++column) {
+      std::fprintf(file, "#column %s %s\n",
+                   ntuple.isInt[column] ? "int" : "double",
+                   ntuple.columns[column].c_str());
+    }
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void OutputWriter::CloseRowFiles()
+{
+  for (auto file : fRowFiles) {
+    if (file && std::fclose(file) != 0) ++fWriteErrors;
+  }
+  fRowFiles.clear();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4String OutputWriter::RowFileName(const Ntuple& ntuple) const
+{
+  // as the analysis manager names csv ntuples: <file>_nt_<ntuple>[_t<thread>]
+  G4String name = StripExtension(fFileName) + "_nt_" + ntuple.name;
+  if (G4Threading::IsWorkerThread()) {
+    name += "_t" + std::to_string(G4Threading::G4GetThreadId());
+  }
+  return name + ".csv";
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void OutputWriter::DefineCommands()
+{
+  fMessenger = new G4GenericMessenger(this, "/b1/output/",
+                                      "Output of histograms and ntuples");
+
+  fMessenger->DeclareProperty("async", fAsync,
+                              "Write the ntuple rows to csv files from a "
+                              "dedicated writer thread, fed by a lock-free "
+                              "queue.")
+    .SetParameterName("async", true)
+    .SetDefaultValue("true")
+    .SetStates(G4State_PreInit, G4State_Idle);
+
+  fMessenger->DeclareProperty("queueSize", fQueueSize,
+                              "Rows queued for the writer at most; a full "
+                              "queue makes the tracking thread wait.")
+    .SetParameterName("rows", false)
+    .SetRange("rows>=2")
+    .SetStates(G4State_PreInit, G4State_Idle);
+
+  fMessenger->DeclareProperty("batchSize", fBatchSize,
+                              "Rows per block handed to the writer.")
+    .SetParameterName("rows", false)
+    .SetRange("rows>=1")
+    .SetStates(G4State_PreInit, G4State_Idle);
+
+  fMessenger->DeclareProperty("format", fFormat,
+                              "Format of the output file (none: no file).")
+    .SetParameterName("format", false)
+    .SetCandidates("root csv hdf5 xml none")
+    .SetStates(G4State_PreInit, G4State_Idle);
+
+  fMessenger->DeclareProperty("ntuples", fNtuples,
+                              "Fill and write the ntuples; false writes the "
+                              "histograms only.")
+    .SetParameterName("ntuples", true)
+    .SetDefaultValue("true")
+    .SetStates(G4State_PreInit, G4State_Idle);
+
+  fMessenger->DeclareProperty("mergeNtuples", fMergeNtuples,
+                              "Merge the worker ntuples into the master file; "
+                              "false writes one file per worker and a "
+                              "manifest. Set before the first run.")
+    .SetParameterName("merge", true)
+    .SetDefaultValue("true")
+    .SetStates(G4State_PreInit, G4State_Idle);
+
+  fMessenger->DeclareProperty("sparseEvents", fSparseEvents,
+                              "Add the event row only for events with an "
+                              "energy deposit or a recoil in the scoring "
+                              "volume.")
+    .SetParameterName("sparse", true)
+    .SetDefaultValue("true")
+    .SetStates(G4State_PreInit, G4State_Idle);
+
+  fMessenger->DeclareProperty("file", fFileName,
+                              "Name of the output file, without extension.")
+    .SetParameterName("name", false)
+    .SetStates(G4State_PreInit, G4State_Idle);
+
+  fMessenger->DeclareProperty("basketSize", fBasketSize,
+                              "Basket size of the ROOT ntuples in bytes "
+                              "(0: Geant4 default).")
+    .SetParameterName("bytes", false)
+    .SetRange("bytes>=0")
+    .SetStates(G4State_PreInit, G4State_Idle);
+
+  fMessenger->DeclareProperty("basketEntries", fBasketEntries,
+                              "Number of entries per basket of the ROOT "
+                              "ntuples (0: Geant4 default).")
+    .SetParameterName("entries", false)
+    .SetRange("entries>=0")
+    .SetStates(G4State_PreInit, G4State_Idle);
+
+  fMessenger->DeclareProperty("compression", fCompression,
+                              "Compression level of the output file, 0-9 "
+                              "(-1: Geant4 default).")
+    .SetParameterName("level", false)
+    .SetRange("level>=-1 && level<=9")
+    .SetStates(G4State_PreInit, G4State_Idle);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+}
@@ -0,0 +1,129 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file PhaseSpace.cc
+/// \brief Implementation of the B1::PhaseSpaceReader class
+
+#include "PhaseSpace.hh"
+
+#include "G4AutoLock.hh"
+
+#include <cstring>
+#include <map>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace B1
+{
+
+const char kPhaseSpaceMagic[8] = { 'B', '1', 'P', 'H', 'S', 'P', '1', '\0' };
+
+namespace
+{
+  G4Mutex openMutex = G4MUTEX_INITIALIZER;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+std::shared_ptr<const PhaseSpaceReader>
+PhaseSpaceReader::Open(const G4String& fileName)
+{
+  // the mapping lives as long as a generator uses it
+  static std::map<G4String, std::weak_ptr<const PhaseSpaceReader>> readers;
+
+  G4AutoLock lock(&openMutex);
+  auto reader = readers[fileName].lock();
+  if (!reader) {
+    reader.reset(new PhaseSpaceReader(fileName));
+    readers[fileName] = reader;
+  }
+  return reader;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+PhaseSpaceReader::PhaseSpaceReader(const G4String& fileName)
+: fFileName(fileName)
+{
+  G4ExceptionDescription msg;
+  int fd = ::open(fileName.c_str(), O_RDONLY);
+  struct stat status;
+  if (fd < 0 || ::fstat(fd, &status) != 0) {
+    msg << "Cannot open phase-space file " << fileName;
+  }
+  else if (std::size_t(status.st_size) < sizeof(PhaseSpaceHeader)) {
+    msg << "Phase-space file " << fileName << " is too short";
+  }
+  else {
+    fMappingSize = status.st_size;
+    fMapping = ::mmap(nullptr, fMappingSize, PROT_READ, MAP_SHARED, fd, 0);
+    if (fMapping == MAP_FAILED) {
+      fMapping = nullptr;
+      msg << "Cannot map phase-space file " << fileName;
+    }
+  }
+  if (fd >= 0) ::close(fd);
+
+  if (fMapping) {
+    const auto* header = static_cast<const PhaseSpaceHeader*>(fMapping);
+    std::uint64_t available
+      = (fMappingSize - sizeof(PhaseSpaceHeader)) / sizeof(PhaseSpaceRecord);
+    if (std::memcmp(header->magic, kPhaseSpaceMagic, sizeof(kPhaseSpaceMagic)) != 0
+        || header->recordSize != sizeof(PhaseSpaceRecord)) {
+      msg << fileName << " is not a phase-space file of this version";
+    }
+    else if (header->nofRecords > available) {
+      msg << "Phase-space file " << fileName << " is truncated: "
+          << header->nofRecords << " records announced, "
+          << available << " present";
+    }
+    else {
+      fNofRecords = header->nofRecords;
+      fRecords = reinterpret_cast<const PhaseSpaceRecord*>(header + 1);
+      // the generators read it front to back
+      ::madvise(fMapping, fMappingSize, MADV_SEQUENTIAL);
+    }
+  }
+
+  if (!fRecords) {
+    G4Exception("PhaseSpaceReader::PhaseSpaceReader()",
+                "MyCode0004", FatalException, msg);
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+PhaseSpaceReader::~PhaseSpaceReader()
+{
+  if (fMapping) ::munmap(fMapping, fMappingSize);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+}
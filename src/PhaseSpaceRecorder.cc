@@ -0,0 +1,283 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file PhaseSpaceRecorder.cc
+/// \brief Implementation of the B1::PhaseSpaceRecorder class
+
+#include "PhaseSpaceRecorder.hh"
+
+#include "G4AutoLock.hh"
+#include "G4GenericMessenger.hh"
+#include "G4ParticleDefinition.hh"
+#include "G4SystemOfUnits.hh"
+#include "G4Threading.hh"
+#include "G4Track.hh"
+#include "G4UnitsTable.hh"
+
+#include <algorithm>
+#include <cstring>
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace B1
+{
+
+namespace
+{
+  const std::size_t kBufferSize = 4096;
+
+  // the part files of the workers, merged by the master
+  G4Mutex partsMutex = G4MUTEX_INITIALIZER;
+  struct Part
+  {
+    G4int thread;
+    G4String fileName;
+    std::uint64_t nofRecords;
+  };
+  std::vector<Part> parts;
+
+  PhaseSpaceHeader MakeHeader(std::uint64_t nofRecords)
+  {
+    PhaseSpaceHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, kPhaseSpaceMagic, sizeof(header.magic));
+    header.recordSize = sizeof(PhaseSpaceRecord);
+    header.nofRecords = nofRecords;
+    return header;
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+PhaseSpaceRecorder::PhaseSpaceRecorder()
+{
+  DefineCommands();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+PhaseSpaceRecorder::~PhaseSpaceRecorder()
+{
+  if (fPart) std::fclose(fPart);
+  delete fMessenger;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void PhaseSpaceRecorder::BeginOfRun(G4bool resuming)
+{
+  fNofRecords = 0;
+  if (!fEnabled) return;
+
+  // in multi-threaded mode the master does not track
+  if (G4Threading::IsMultithreadedApplication() && G4Threading::IsMasterThread()) {
+    return;
+  }
+
+  fPartName = fFileName + ".part"
+              + std::to_string(std::max(G4Threading::G4GetThreadId(), 0));
+  // the records before the checkpoint are kept for a resumed run
+  fPart = resuming ? std::fopen(fPartName.c_str(), "r+b") : nullptr;
+  if (!fPart) fPart = std::fopen(fPartName.c_str(), "wb");
+  if (!fPart) {
+    G4ExceptionDescription msg;
+    msg << "Cannot write phase-space part file " << fPartName;
+    G4Exception("PhaseSpaceRecorder::BeginOfRun()",
+                "MyCode0005", JustWarning, msg);
+    return;
+  }
+  fBuffer.reserve(kBufferSize);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void PhaseSpaceRecorder::Record(const G4Step* step)
+{
+  const G4StepPoint* pre = step->GetPreStepPoint();
+  const G4StepPoint* post = step->GetPostStepPoint();
+  const G4ThreeVector& p0 = pre->GetPosition();
+  const G4ThreeVector& p1 = post->GetPosition();
+  const G4ThreeVector& direction = pre->GetMomentumDirection();
+
+  // straight line between the step points, the direction at the start
+  G4double f = (p1.z() > p0.z()) ? (fPlaneZ - p0.z()) / (p1.z() - p0.z()) : 0.;
+  G4Track* track = step->GetTrack();
+
+  PhaseSpaceRecord record;
+  record.pdg = track->GetDefinition()->GetPDGEncoding();
+  record.energy = float(pre->GetKineticEnergy() / MeV);
+  record.x = float((p0.x() + f * (p1.x() - p0.x())) / mm);
+  record.y = float((p0.y() + f * (p1.y() - p0.y())) / mm);
+  record.z = float(fPlaneZ / mm);
+  record.dx = float(direction.x());
+  record.dy = float(direction.y());
+  record.dz = float(direction.z());
+  record.weight = float(track->GetWeight());
+
+  fBuffer.push_back(record);
+  if (fBuffer.size() == kBufferSize) Flush();
+
+  if (fKill) track->SetTrackStatus(fStopAndKill);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void PhaseSpaceRecorder::Flush()
+{
+  if (fBuffer.empty()) return;
+  std::fwrite(fBuffer.data(), sizeof(PhaseSpaceRecord), fBuffer.size(), fPart);
+  fNofRecords += fBuffer.size();
+  fBuffer.clear();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+std::uint64_t PhaseSpaceRecorder::Sync()
+{
+  if (!fPart) return 0;
+  Flush();
+  std::fflush(fPart);
+  return fNofRecords;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool PhaseSpaceRecorder::Restore(G4bool recording, std::uint64_t nofRecords)
+{
+  if (recording != IsRecording()) return false;
+  if (!fPart) return true;
+
+  // the records after the checkpoint are dropped; the resumed events write
+  // them again
+  off_t size = off_t(nofRecords * sizeof(PhaseSpaceRecord));
+  struct stat status;
+  if (::fstat(::fileno(fPart), &status) != 0 || status.st_size < size
+      || ::ftruncate(::fileno(fPart), size) != 0
+      || std::fseek(fPart, 0, SEEK_END) != 0) {
+    return false;
+  }
+  fNofRecords = nofRecords;
+  return true;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void PhaseSpaceRecorder::EndOfRun(G4bool isMaster)
+{
+  if (fPart) {
+    Flush();
+    std::fclose(fPart);
+    fPart = nullptr;
+
+    G4AutoLock lock(&partsMutex);
+    parts.push_back({ G4Threading::G4GetThreadId(), fPartName, fNofRecords });
+  }
+
+  if (isMaster) Merge();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void PhaseSpaceRecorder::Merge()
+{
+  G4AutoLock lock(&partsMutex);
+  if (parts.empty()) return;
+
+  // the parts in thread order, so that the file does not depend on the
+  // order in which the workers ended
+  std::sort(parts.begin(), parts.end(),
+            [](const Part& a, const Part& b) { return a.thread < b.thread; });
+
+  std::uint64_t total = 0;
+  for (const auto& part : parts) total += part.nofRecords;
+
+  std::FILE* out = std::fopen(fFileName.c_str(), "wb");
+  if (!out) {
+    G4ExceptionDescription msg;
+    msg << "Cannot write phase-space file " << fFileName
+        << "; the part files are kept";
+    G4Exception("PhaseSpaceRecorder::Merge()",
+                "MyCode0005", JustWarning, msg);
+    parts.clear();
+    return;
+  }
+
+  PhaseSpaceHeader header = MakeHeader(total);
+  std::fwrite(&header, sizeof(header), 1, out);
+
+  std::vector<char> chunk(kBufferSize * sizeof(PhaseSpaceRecord));
+  for (const auto& part : parts) {
+    std::FILE* in = std::fopen(part.fileName.c_str(), "rb");
+    if (!in) continue;
+    std::size_t n;
+    while ((n = std::fread(chunk.data(), 1, chunk.size(), in)) > 0) {
+      std::fwrite(chunk.data(), 1, n, out);
+    }
+    std::fclose(in);
+    std::remove(part.fileName.c_str());
+  }
+  std::fclose(out);
+
+  G4cout << " Phase space: " << total << " particles at z = "
+         << G4BestUnit(fPlaneZ, "Length") << " written to " << fFileName
+         << G4endl;
+  parts.clear();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void PhaseSpaceRecorder::DefineCommands()
+{
+  fMessenger = new G4GenericMessenger(this, "/b1/phsp/",
+                                      "Phase-space recording");
+
+  fMessenger->DeclareProperty("record", fEnabled,
+                              "Record the particles crossing the plane.")
+    .SetParameterName("record", true)
+    .SetDefaultValue("true")
+    .SetStates(G4State_PreInit, G4State_Idle);
+
+  fMessenger->DeclareProperty("file", fFileName,
+                              "Output phase-space file.")
+    .SetParameterName("file", false)
+    .SetStates(G4State_PreInit, G4State_Idle);
+
+  fMessenger->DeclarePropertyWithUnit("z", "mm", fPlaneZ,
+                                      "Position of the scoring plane.")
+    .SetParameterName("z", false)
+    .SetStates(G4State_PreInit, G4State_Idle);
+
+  fMessenger->DeclareProperty("kill", fKill,
+                              "Stop the recorded particles at the plane.")
+    .SetParameterName("kill", true)
+    .SetDefaultValue("true")
+    .SetStates(G4State_PreInit, G4State_Idle);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+}
@@ -0,0 +1,277 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file PhiloxEngine.cc
+/// \brief Implementation of the B1::PhiloxEngine class
+
+#include "PhiloxEngine.hh"
+
+#include <fstream>
+#include <iostream>
+#include <string>
+
+namespace B1
+{
+
+namespace
+{
+  const std::uint32_t kMul0 = 0xD2511F53;
+  const std::uint32_t kMul1 = 0xCD9E8D57;
+  const std::uint32_t kWeyl0 = 0x9E3779B9;
+  const std::uint32_t kWeyl1 = 0xBB67AE85;
+
+  // tag of the vector state, checked by get()
+  const unsigned long kVectorTag = 0x50484c58;   // "PHLX"
+  const std::size_t kVectorSize = 9;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+PhiloxEngine::PhiloxEngine()
+{
+  setSeed(19780503);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+PhiloxEngine::PhiloxEngine(long seed)
+{
+  setSeed(seed);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+PhiloxEngine::Block PhiloxEngine::Generate(const Block& counter,
+                                           std::uint32_t key0,
+                                           std::uint32_t key1)
+{
+  Block x = counter;
+  for (int round = 0; round < 10; ++round) {
+    std::uint64_t p0 = std::uint64_t(kMul0) * x[0];
+    std::uint64_t p1 = std::uint64_t(kMul1) * x[2];
+    x = { std::uint32_t(p1 >> 32) ^ x[1] ^ key0, std::uint32_t(p1),
+          std::uint32_t(p0 >> 32) ^ x[3] ^ key1, std::uint32_t(p0) };
+    key0 += kWeyl0;
+    key1 += kWeyl1;
+  }
+  return x;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+double PhiloxEngine::ToDouble(std::uint32_t hi, std::uint32_t lo)
+{
+  // 53 bits, centred in their interval: never 0 or 1
+  std::uint64_t bits = ((std::uint64_t(hi) << 32) | lo) >> 11;
+  return (double(bits) + 0.5) * (1.0 / 9007199254740992.0);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void PhiloxEngine::Increment()
+{
+  for (auto& word : fCounter) {
+    if (++word != 0) break;
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+double PhiloxEngine::flat()
+{
+  if (fUsed == 2) {
+    fOutput = Generate(fCounter, fKey0, fKey1);
+    Increment();
+    fUsed = 0;
+  }
+  double value = ToDouble(fOutput[2 * fUsed], fOutput[2 * fUsed + 1]);
+  ++fUsed;
+  return value;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void PhiloxEngine::flatArray(const int size, double* vect)
+{
+  int i = 0;
+  // finish the current block, so that the stream does not depend on how
+  // it is split into calls
+  while (i < size && fUsed < 2) vect[i++] = flat();
+
+  for (; i + 1 < size; i += 2) {
+    Block out = Generate(fCounter, fKey0, fKey1);
+    Increment();
+    vect[i] = ToDouble(out[0], out[1]);
+    vect[i + 1] = ToDouble(out[2], out[3]);
+  }
+  if (i < size) vect[i] = flat();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void PhiloxEngine::setSeed(long seed, int)
+{
+  theSeed = seed;
+  auto bits = static_cast<unsigned long>(seed);
+  fKey0 = std::uint32_t(bits);
+  fKey1 = std::uint32_t(std::uint64_t(bits) >> 32);
+  fCounter = { 0, 0, 0, 0 };
+  fUsed = 2;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void PhiloxEngine::setSeeds(const long* seeds, int)
+{
+  // the first two seeds form the key; the array may be zero terminated
+  theSeeds = seeds;
+  theSeed = seeds[0];
+  fKey0 = std::uint32_t(seeds[0]);
+  fKey1 = (seeds[0] != 0) ? std::uint32_t(seeds[1]) : 0;
+  fCounter = { 0, 0, 0, 0 };
+  fUsed = 2;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void PhiloxEngine::saveStatus(const char filename[]) const
+{
+  std::ofstream os(filename, std::ios::out);
+  if (!os.bad()) put(os);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void PhiloxEngine::restoreStatus(const char filename[])
+{
+  std::ifstream is(filename, std::ios::in);
+  if (!is.bad()) get(is);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void PhiloxEngine::showStatus() const
+{
+  std::cout << "--------- Philox engine status ---------" << std::endl
+            << " Key     = " << fKey0 << " " << fKey1 << std::endl
+            << " Counter = " << fCounter[0] << " " << fCounter[1] << " "
+            << fCounter[2] << " " << fCounter[3] << std::endl
+            << " Used    = " << fUsed << std::endl
+            << "----------------------------------------" << std::endl;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+std::vector<unsigned long> PhiloxEngine::put() const
+{
+  return { kVectorTag, fKey0, fKey1, fCounter[0], fCounter[1],
+           fCounter[2], fCounter[3], (unsigned long)(fUsed),
+           (unsigned long)(theSeed) };
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+bool PhiloxEngine::get(const std::vector<unsigned long>& v)
+{
+  if (v.empty() || v[0] != kVectorTag) {
+    std::cerr << "PhiloxEngine::get(): vector has the wrong engine tag"
+              << std::endl;
+    return false;
+  }
+  return getState(v);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+bool PhiloxEngine::getState(const std::vector<unsigned long>& v)
+{
+  if (v.size() != kVectorSize) {
+    std::cerr << "PhiloxEngine::getState(): vector has the wrong length"
+              << std::endl;
+    return false;
+  }
+  fKey0 = std::uint32_t(v[1]);
+  fKey1 = std::uint32_t(v[2]);
+  fCounter = { std::uint32_t(v[3]), std::uint32_t(v[4]),
+               std::uint32_t(v[5]), std::uint32_t(v[6]) };
+  fUsed = int(v[7]);
+  theSeed = long(v[8]);
+
+  // the current block is recomputed from the counter it was drawn at
+  if (fUsed < 2) {
+    Block counter = fCounter;
+    for (auto& word : counter) {
+      if (word-- != 0) break;
+    }
+    fOutput = Generate(counter, fKey0, fKey1);
+  }
+  return true;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+std::ostream& PhiloxEngine::put(std::ostream& os) const
+{
+  os << beginTag() << "\n" << engineName() << "-begin";
+  for (auto word : put()) os << " " << word;
+  os << " " << engineName() << "-end\n";
+  return os;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+std::istream& PhiloxEngine::get(std::istream& is)
+{
+  std::string tag;
+  is >> tag;
+  if (tag == beginTag()) is >> tag;
+  if (tag != engineName() + "-begin") {
+    is.clear(std::ios::badbit | is.rdstate());
+    std::cerr << "PhiloxEngine::get(): no " << engineName()
+              << " state found" << std::endl;
+    return is;
+  }
+  return getState(is);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+std::istream& PhiloxEngine::getState(std::istream& is)
+{
+  std::vector<unsigned long> v(kVectorSize);
+  for (auto& word : v) is >> word;
+  std::string tag;
+  is >> tag;
+  if (!is || tag != engineName() + "-end" || !getState(v)) {
+    is.clear(std::ios::badbit | is.rdstate());
+    std::cerr << "PhiloxEngine::getState(): corrupt state" << std::endl;
+  }
+  return is;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+}
@@ -0,0 +1,299 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file PrecisionTarget.cc
+/// \brief Implementation of the B1::PrecisionTarget class
+
+#include "PrecisionTarget.hh"
+
+#include "G4AutoLock.hh"
+#include "G4GenericMessenger.hh"
+#include "G4RunManager.hh"
+#include "G4Threading.hh"
+
+#include <atomic>
+#include <cmath>
+#include <iomanip>
+#include <istream>
+#include <limits>
+#include <ostream>
+
+namespace B1
+{
+
+namespace
+{
+  // totals of all threads
+  G4Mutex precisionMutex = G4MUTEX_INITIALIZER;
+  PrecisionTarget::Moments totalEdep;
+  PrecisionTarget::Moments totalPkaCount;
+  PrecisionTarget::Moments totalPkaEnergy;
+  G4double reachedError = 0.;
+  std::atomic<G4bool> converged{false};
+
+  void SaveMoments(std::ostream& out, const PrecisionTarget::Moments& m)
+  {
+    out << m.n << ' ' << m.mean << ' ' << m.m2 << '\n';
+  }
+
+  G4bool RestoreMoments(std::istream& in, PrecisionTarget::Moments& m)
+  {
+    PrecisionTarget::Moments restored;
+    in >> restored.n >> restored.mean >> restored.m2;
+    if (!in || restored.n < 0.) return false;
+    m = restored;
+    return true;
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void PrecisionTarget::Moments::Add(G4double value)
+{
+  n += 1.;
+  G4double delta = value - mean;
+  mean += delta / n;
+  m2 += delta * (value - mean);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void PrecisionTarget::Moments::Merge(const Moments& other)
+{
+  if (other.n == 0.) return;
+  G4double total = n + other.n;
+  G4double delta = other.mean - mean;
+  mean += delta * other.n / total;
+  m2 += other.m2 + delta * delta * n * other.n / total;
+  n = total;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4double PrecisionTarget::Moments::RelativeError() const
+{
+  if (n < 2. || mean <= 0.) return std::numeric_limits<G4double>::infinity();
+  return std::sqrt(m2 / (n - 1.) / n) / mean;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+PrecisionTarget::PrecisionTarget()
+{
+  DefineCommands();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+PrecisionTarget::~PrecisionTarget()
+{
+  delete fMessenger;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void PrecisionTarget::BeginOfRun(G4bool isMaster)
+{
+  fActive = fPrecision > 0.;
+  fAborted = false;
+  fEventPkas = 0;
+  fEdep = Moments();
+  fPkaCount = Moments();
+  fPkaEnergy = Moments();
+
+  // the master begins the run before the workers are started
+  if (isMaster) {
+    G4AutoLock lock(&precisionMutex);
+    totalEdep = Moments();
+    totalPkaCount = Moments();
+    totalPkaEnergy = Moments();
+    reachedError = std::numeric_limits<G4double>::infinity();
+    converged = false;
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void PrecisionTarget::CountPka(G4double energy)
+{
+  if (!fActive) return;
+  ++fEventPkas;
+  fPkaEnergy.Add(energy);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void PrecisionTarget::EndOfEvent(G4double edep)
+{
+  if (!fActive) return;
+
+  fEdep.Add(edep);
+  fPkaCount.Add(fEventPkas);
+  fEventPkas = 0;
+
+  if (G4int(fEdep.n) >= fCheckInterval) Check();
+
+  if (!fAborted && converged.load(std::memory_order_relaxed)) {
+    // soft abort: the event loop of this thread ends after this event
+    G4RunManager::GetRunManager()->AbortRun(true);
+    fAborted = true;
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void PrecisionTarget::Check()
+{
+  G4AutoLock lock(&precisionMutex);
+  totalEdep.Merge(fEdep);
+  totalPkaCount.Merge(fPkaCount);
+  totalPkaEnergy.Merge(fPkaEnergy);
+  fEdep = Moments();
+  fPkaCount = Moments();
+  fPkaEnergy = Moments();
+
+  if (fObservable == "pkaCount") reachedError = totalPkaCount.RelativeError();
+  else if (fObservable == "pkaMeanEnergy") {
+    reachedError = totalPkaEnergy.RelativeError();
+  }
+  else reachedError = totalEdep.RelativeError();
+
+  if (totalEdep.n >= fMinEvents && reachedError <= fPrecision) {
+    converged = true;
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void PrecisionTarget::EndOfRun(G4bool isMaster)
+{
+  if (!fActive) return;
+
+  // the events since the last check of this thread
+  Check();
+  if (!isMaster) return;
+
+  G4AutoLock lock(&precisionMutex);
+  G4cout
+    << G4endl
+    << " Precision target " << fPrecision << " on " << fObservable << ": "
+    << (converged ? "reached" : "not reached") << " after "
+    << totalEdep.n << " events, relative error " << reachedError << G4endl;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void PrecisionTarget::Save(std::ostream& out) const
+{
+  G4AutoLock lock(&precisionMutex);
+  out << std::setprecision(17) << fActive << '\n';
+  SaveMoments(out, totalEdep);
+  SaveMoments(out, totalPkaCount);
+  SaveMoments(out, totalPkaEnergy);
+  SaveMoments(out, fEdep);
+  SaveMoments(out, fPkaCount);
+  SaveMoments(out, fPkaEnergy);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool PrecisionTarget::Restore(std::istream& in)
+{
+  G4bool active = false;
+  Moments edep, pkaCount, pkaEnergy;
+  Moments batchEdep, batchPkaCount, batchPkaEnergy;
+  in >> active;
+  if (!in || !RestoreMoments(in, edep) || !RestoreMoments(in, pkaCount)
+      || !RestoreMoments(in, pkaEnergy) || !RestoreMoments(in, batchEdep)
+      || !RestoreMoments(in, batchPkaCount)
+      || !RestoreMoments(in, batchPkaEnergy))
+  {
+    return false;
+  }
+
+  if (!fActive) return true;
+  if (!active) {
+    G4ExceptionDescription ed;
+    ed << "The checkpoint was taken without a precision target; the "
+       << "estimate starts with the resumed events.";
+    G4Exception("PrecisionTarget::Restore()", "MyCode0005", JustWarning, ed);
+    return true;
+  }
+
+  fEdep = batchEdep;
+  fPkaCount = batchPkaCount;
+  fPkaEnergy = batchPkaEnergy;
+
+  G4AutoLock lock(&precisionMutex);
+  totalEdep = edep;
+  totalPkaCount = pkaCount;
+  totalPkaEnergy = pkaEnergy;
+  if (totalEdep.n > 0.) {
+    if (fObservable == "pkaCount") reachedError = totalPkaCount.RelativeError();
+    else if (fObservable == "pkaMeanEnergy") {
+      reachedError = totalPkaEnergy.RelativeError();
+    }
+    else reachedError = totalEdep.RelativeError();
+  }
+  return true;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void PrecisionTarget::DefineCommands()
+{
+  fMessenger = new G4GenericMessenger(this, "/b1/run/",
+                                      "Run length control");
+
+  fMessenger->DeclareProperty("precision", fPrecision,
+                              "Stop the run when the relative standard "
+                              "error of the observable is at most this "
+                              "(0: run all events of /run/beamOn).")
+    .SetParameterName("r", false)
+    .SetRange("r>=0.")
+    .SetStates(G4State_PreInit, G4State_Idle);
+
+  fMessenger->DeclareProperty("observable", fObservable,
+                              "Observable of the precision target.")
+    .SetCandidates("dose pkaCount pkaMeanEnergy")
+    .SetStates(G4State_PreInit, G4State_Idle);
+
+  fMessenger->DeclareProperty("checkInterval", fCheckInterval,
+                              "Events of a thread between two checks.")
+    .SetParameterName("events", false)
+    .SetRange("events>=1")
+    .SetStates(G4State_PreInit, G4State_Idle);
+
+  fMessenger->DeclareProperty("minEvents", fMinEvents,
+                              "Events before the run may be stopped.")
+    .SetParameterName("events", false)
+    .SetRange("events>=2")
+    .SetStates(G4State_PreInit, G4State_Idle);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+}
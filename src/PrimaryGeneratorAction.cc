@@ -28,18 +28,28 @@
 /// \brief Implementation of the B1::PrimaryGeneratorAction class
 
 #include "PrimaryGeneratorAction.hh"
+#include "Checkpoint.hh"
 
-#include "G4LogicalVolumeStore.hh"
-#include "G4LogicalVolume.hh"
-#include "G4Box.hh"
+#include "G4Event.hh"
+#include "G4IonTable.hh"
+#include "G4PrimaryParticle.hh"
+#include "G4PrimaryVertex.hh"
 #include "G4RunManager.hh"
+#include "G4Threading.hh"
 #include "G4ParticleGun.hh"
 #include "G4ParticleTable.hh"
 #include "G4ParticleDefinition.hh"
+#include "G4GenericMessenger.hh"
 #include "G4SystemOfUnits.hh"
 #include "Randomize.hh"
 #include "DetectorConstruction.hh"
 
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <istream>
+#include <ostream>
+
 namespace B1
 {
 
@@ -58,6 +68,9 @@ PrimaryGeneratorAction::PrimaryGeneratorAction()
   fParticleGun->SetParticleDefinition(particle);
   fParticleGun->SetParticleMomentumDirection(G4ThreeVector(0.,0.,1.));
   fParticleGun->SetParticleEnergy(24000.*MeV);
+
+  BuildSpectrumTable();
+  DefineCommands();
 }
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -65,8 +78,18 @@ PrimaryGeneratorAction::PrimaryGeneratorAction()
 PrimaryGeneratorAction::~PrimaryGeneratorAction()
 {
   delete fParticleGun;
+  delete fMessenger;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4double PrimaryGeneratorAction::SpectrumDensity(G4double E)
+{
+  return 0.470 * std::exp(-0.693 * E) + 0.39 * std::exp(-0.97 * E) / std::pow(E, 0.88);
 }
 
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
 //fast neutron energy spectrum
 G4double PrimaryGeneratorAction::GetEnergyFromSpectrum()
 {
@@ -76,16 +99,190 @@ G4double PrimaryGeneratorAction::GetEnergyFromSpectrum()
 
     while (true)
     {
-        E = G4UniformRand() * (7 - 0.000001) + 0.000001;  // 随机生成能量
-        probability = (0.470 * std::exp(-0.693 * E) + 0.39 * std::exp(-0.97 * E) / std::pow(E, 0.88)) * 1e12;
+        E = fRandom.Flat() * (7 - 0.000001) + 0.000001;  // 随机生成能量
+        probability = SpectrumDensity(E) * 1e12;
 
-        if (G4UniformRand() * maxProbability < probability)
+        if (fRandom.Flat() * maxProbability < probability)
         {
             return E * MeV;
         }
     }
 }
 
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void PrimaryGeneratorAction::BuildSpectrumTable()
+{
+  // Cumulative integral of the spectrum on a log grid over the range of the
+  // rejection sampling, 1 eV - 7 MeV; the trapezoid rule on the fine grid
+  // handles the E^-0.88 rise at low energies.
+  const G4int nPoints = 4096;
+  const G4double eMin = 0.000001, eMax = 7.;
+  const G4double ratio = std::pow(eMax / eMin, 1. / (nPoints - 1));
+
+  fSpectrumEnergies.resize(nPoints);
+  fSpectrumCdf.resize(nPoints);
+  G4double energy = eMin;
+  for (G4int i = 0; i < nPoints; ++i, energy *= ratio) {
+    fSpectrumEnergies[i] = (i == nPoints - 1) ? eMax : energy;
+    fSpectrumCdf[i] = (i == 0) ? 0. :
+      fSpectrumCdf[i - 1] + 0.5 * (fSpectrumEnergies[i] - fSpectrumEnergies[i - 1])
+        * (SpectrumDensity(fSpectrumEnergies[i]) + SpectrumDensity(fSpectrumEnergies[i - 1]));
+  }
+  for (auto& value : fSpectrumCdf) value /= fSpectrumCdf.back();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4double PrimaryGeneratorAction::GetEnergyFromTable()
+{
+  G4double u = fRandom.Flat();
+  auto it = std::upper_bound(fSpectrumCdf.begin(), fSpectrumCdf.end(), u);
+  std::size_t i = std::min<std::size_t>(it - fSpectrumCdf.begin(), fSpectrumCdf.size() - 1);
+  // linear interpolation within the interval [i-1, i]
+  G4double f = (u - fSpectrumCdf[i - 1]) / (fSpectrumCdf[i] - fSpectrumCdf[i - 1]);
+  return (fSpectrumEnergies[i - 1] + f * (fSpectrumEnergies[i] - fSpectrumEnergies[i - 1])) * MeV;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4double PrimaryGeneratorAction::SampleEnergy()
+{
+  if (fSpectrumMode == "table") return GetEnergyFromTable();
+  if (fSpectrumMode == "rejection") return GetEnergyFromSpectrum();
+  return fParticleGun->GetParticleEnergy();
+}
+
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void PrimaryGeneratorAction::OpenPhaseSpace()
+{
+  fPhaseSpace = PhaseSpaceReader::Open(fPhaseSpaceFile);
+
+  // contiguous share of this thread; the whole file in sequential mode
+  std::uint64_t size = fPhaseSpace->GetSize();
+  std::uint64_t nofThreads = 1, thread = 0;
+  if (G4Threading::IsMultithreadedApplication()) {
+    nofThreads = std::max(G4Threading::GetNumberOfRunningWorkerThreads(), 1);
+    thread = std::max(G4Threading::G4GetThreadId(), 0);
+  }
+  fPhaseSpaceBegin = size * thread / nofThreads;
+  fPhaseSpaceEnd = size * (thread + 1) / nofThreads;
+  fPhaseSpaceNext = fPhaseSpaceBegin;
+  fPhaseSpaceRecycled = false;
+
+  if (fPhaseSpaceBegin == fPhaseSpaceEnd) {
+    G4ExceptionDescription msg;
+    msg << "Phase-space file " << fPhaseSpaceFile << " has "
+        << size << " records, none for thread " << thread << ".";
+    G4Exception("PrimaryGeneratorAction::OpenPhaseSpace()",
+                "MyCode0004", FatalException, msg);
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void PrimaryGeneratorAction::Save(std::ostream& out) const
+{
+  // the first vertex of an event is generated before the gun is moved, so
+  // the next event depends on the kinematics left by this one
+  G4ThreeVector position = fParticleGun->GetParticlePosition();
+  G4ThreeVector direction = fParticleGun->GetParticleMomentumDirection();
+  out << std::setprecision(17)
+      << position.x() << ' ' << position.y() << ' ' << position.z() << ' '
+      << direction.x() << ' ' << direction.y() << ' ' << direction.z() << ' '
+      << fParticleGun->GetParticleEnergy() << ' '
+      << (fPhaseSpace ? fPhaseSpaceNext - fPhaseSpaceBegin : 0) << '\n';
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool PrimaryGeneratorAction::Restore(std::istream& in)
+{
+  G4double x, y, z, dx, dy, dz, energy;
+  std::uint64_t phaseSpaceRecords = 0;
+  in >> x >> y >> z >> dx >> dy >> dz >> energy >> phaseSpaceRecords;
+  if (!in) return false;
+
+  fParticleGun->SetParticlePosition(G4ThreeVector(x, y, z));
+  fParticleGun->SetParticleMomentumDirection(G4ThreeVector(dx, dy, dz));
+  fParticleGun->SetParticleEnergy(energy);
+
+  if (fSource == "phaseSpace") {
+    OpenPhaseSpace();
+    fPhaseSpaceNext = std::min(fPhaseSpaceBegin + phaseSpaceRecords,
+                               fPhaseSpaceEnd);
+  }
+  return true;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+const G4ParticleDefinition* PrimaryGeneratorAction::FindParticle(G4int pdg)
+{
+  auto it = fParticles.find(pdg);
+  if (it != fParticles.end()) return it->second;
+
+  const G4ParticleDefinition* particle
+    = G4ParticleTable::GetParticleTable()->FindParticle(pdg);
+  if (!particle && pdg > 1000000000) {
+    particle = G4IonTable::GetIonTable()->GetIon(pdg);
+  }
+  if (!particle) {
+    G4ExceptionDescription msg;
+    msg << "Unknown PDG code " << pdg << " in phase-space file "
+        << fPhaseSpaceFile << "; such records are skipped.";
+    G4Exception("PrimaryGeneratorAction::FindParticle()",
+                "MyCode0004", JustWarning, msg);
+  }
+  fParticles[pdg] = particle;
+  return particle;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void PrimaryGeneratorAction::GeneratePhaseSpace(G4Event* anEvent)
+{
+  if (!fPhaseSpace || fPhaseSpace->GetFileName() != fPhaseSpaceFile) {
+    OpenPhaseSpace();
+  }
+
+  for (G4int i = 0; i < fPhaseSpaceParticles; ++i) {
+    if (fPhaseSpaceNext == fPhaseSpaceEnd) {
+      if (!fPhaseSpaceRecycled) {
+        G4ExceptionDescription msg;
+        msg << "The phase-space records of this thread are used up; "
+            << "they are reused from the beginning.";
+        G4Exception("PrimaryGeneratorAction::GeneratePhaseSpace()",
+                    "MyCode0004", JustWarning, msg);
+        fPhaseSpaceRecycled = true;
+      }
+      fPhaseSpaceNext = fPhaseSpaceBegin;
+    }
+    const PhaseSpaceRecord& record = (*fPhaseSpace)[fPhaseSpaceNext++];
+
+    const G4ParticleDefinition* particle = FindParticle(record.pdg);
+    if (!particle) continue;
+
+    auto primary = new G4PrimaryParticle(particle);
+    primary->SetKineticEnergy(record.energy * MeV);
+    primary->SetMomentumDirection(
+      G4ThreeVector(record.dx, record.dy, record.dz).unit());
+    primary->SetWeight(record.weight);
+
+    auto vertex = new G4PrimaryVertex(
+      G4ThreeVector(record.x * mm, record.y * mm, record.z * mm), 0.);
+    vertex->SetPrimary(primary);
+    vertex->SetWeight(record.weight);
+    anEvent->AddPrimaryVertex(vertex);
+
+    if (i == 0) fPrimaryEnergies.push_back(record.energy * MeV);
+    if (fPrimaryParticleName.empty()) {
+      fPrimaryParticleName = particle->GetParticleName();
+    }
+  }
+}
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
@@ -94,9 +291,6 @@ void PrimaryGeneratorAction::GeneratePrimaries(G4Event* anEvent)
   //this function is called at the begining of ecah event
   //
 
-  // In order to avoid dependence of PrimaryGeneratorAction
-  // on DetectorConstruction class we get Envelope volume
-  // from G4LogicalVolumeStore.
     // 获取从能谱分布中抽取的能量
 
   // G4double energy = fParticleGun->GetParticleEnergy();
@@ -104,50 +298,43 @@ void PrimaryGeneratorAction::GeneratePrimaries(G4Event* anEvent)
   //   // 设置粒子枪的能量
   // fParticleGun->SetParticleEnergy(energy);
   // fPrimaryEnergies.push_back(energy); // 
+  if (fSource == "phaseSpace") {
+    GeneratePhaseSpace(anEvent);
+    return;
+  }
+
+  // the numbers of this event in one block, see RandomBatch: the energy of
+  // both vertices (the rejection loop accepts its first candidate) and the
+  // beam profile
+  G4int perEnergy = (fSpectrumMode == "table") ? 1
+                    : (fSpectrumMode == "rejection") ? 2 : 0;
+  fRandom.Fill(2 * perEnergy + fBeamProfile.NumbersPerEvent());
+
+  if (fSpectrumMode != "off") fParticleGun->SetParticleEnergy(SampleEnergy());
   G4double energyBefore = fParticleGun->GetParticleEnergy();
   fParticleGun->GeneratePrimaryVertex(anEvent);
   G4double energyAfter = fParticleGun->GetParticleEnergy();
   fPrimaryEnergies.push_back(fParticleGun->GetParticleEnergy()); // 仅记录
 
-  G4cout << "Energy before generation: " << energyBefore / MeV << " MeV" << G4endl;
-  G4cout << "Energy after generation: " << energyAfter / MeV << " MeV" << G4endl;
+  if (fVerbose > 0) {
+    G4cout << "Energy before generation: " << energyBefore / MeV << " MeV" << G4endl;
+    G4cout << "Energy after generation: " << energyAfter / MeV << " MeV" << G4endl;
+  }
 
   if (fPrimaryParticleName.empty()) {
     fPrimaryParticleName = fParticleGun->GetParticleDefinition()->GetParticleName(); // 
   }
-  G4double envSizeXY = 0;
-  G4double envSizeZ = 0;
-
-  if (!fEnvelopeBox)
-  {
-    G4LogicalVolume* envLV
-      = G4LogicalVolumeStore::GetInstance()->GetVolume("Envelope");
-    if ( envLV ) fEnvelopeBox = dynamic_cast<G4Box*>(envLV->GetSolid());
-  }
-
-  if ( fEnvelopeBox ) {
-    envSizeXY = fEnvelopeBox->GetXHalfLength();
-    envSizeZ = fEnvelopeBox->GetZHalfLength();
-  }
-  else  {
-    G4ExceptionDescription msg;
-    msg << "Envelope volume of box shape not found.\n";
-    msg << "Perhaps you have changed geometry.\n";
-    msg << "The gun will be place at the center.";
-    G4Exception("PrimaryGeneratorAction::GeneratePrimaries()",
-     "MyCode0002",JustWarning,msg);
-  }
-
-  G4double size = 0.005;
-  G4double x0 = size * envSizeXY * (G4UniformRand()-0.5);
-  G4double y0 = size * envSizeXY * (G4UniformRand()-0.5);
-  G4double z0 = 0 * envSizeZ;
-  //G4cout << "particle_gun_position"<<"|" << envSizeXY/CLHEP::nm <<"|" <<envSizeXY/CLHEP::nm <<"|" << envSizeZ/CLHEP::nm << G4endl;
-  fParticleGun->SetParticlePosition(G4ThreeVector(x0,y0,z0));
-  G4cout << "particle_gun_position" << x0/CLHEP::nm <<"|" <<y0/CLHEP::nm<<"|" << z0/CLHEP::nm << G4endl;
-
 
+  G4ThreeVector position, direction;
+  // continue the raster pattern of a resumed run, see Checkpoint
+  G4int eventID = anEvent->GetEventID() + Checkpoint::GetEventOffset();
+  fBeamProfile.Generate(fRandom, eventID, position, direction);
+  fParticleGun->SetParticlePosition(position);
+  fParticleGun->SetParticleMomentumDirection(direction);
+  if (fVerbose > 0)
+  G4cout << "particle_gun_position" << position.x()/CLHEP::nm <<"|" <<position.y()/CLHEP::nm<<"|" << position.z()/CLHEP::nm << G4endl;
 
+  if (fSpectrumMode != "off") fParticleGun->SetParticleEnergy(SampleEnergy());
   fParticleGun->GeneratePrimaryVertex(anEvent);
 }
   G4double PrimaryGeneratorAction::GetPrimaryEnergy() const {
@@ -163,6 +350,42 @@ void PrimaryGeneratorAction::GeneratePrimaries(G4Event* anEvent)
 std::vector<G4double> PrimaryGeneratorAction::GetPrimaryEnergies() const {
   return fPrimaryEnergies;
 }
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void PrimaryGeneratorAction::DefineCommands()
+{
+  fMessenger = new G4GenericMessenger(this, "/b1/gun/",
+                                      "Primary generator");
+
+  fMessenger->DeclareProperty("spectrum", fSpectrumMode,
+                              "Energy of the primaries: off (gun energy), "
+                              "rejection (original sampling of the fast "
+                              "neutron spectrum) or table (inverse CDF).")
+    .SetParameterName("mode", false)
+    .SetCandidates("off rejection table");
+
+  fMessenger->DeclareProperty("source", fSource,
+                              "gun: particle gun and beam profile, "
+                              "phaseSpace: records of a phase-space file.")
+    .SetParameterName("source", false)
+    .SetCandidates("gun phaseSpace");
+
+  fMessenger->DeclareProperty("phaseSpaceFile", fPhaseSpaceFile,
+                              "Phase-space file read in phaseSpace mode.")
+    .SetParameterName("file", false);
+
+  fMessenger->DeclareProperty("phaseSpaceParticles", fPhaseSpaceParticles,
+                              "Number of phase-space records per event.")
+    .SetParameterName("N", false)
+    .SetRange("N>=1");
+
+  fMessenger->DeclareProperty("verbose", fVerbose,
+                              "0: nothing per event, 1: the energy and "
+                              "position of every primary.")
+    .SetParameterName("level", false)
+    .SetRange("level>=0 && level<=1");
+}
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
 }
@@ -0,0 +1,108 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file RandomEngineSelector.cc
+/// \brief Implementation of the B1::RandomEngineSelector class
+
+#include "RandomEngineSelector.hh"
+#include "PhiloxEngine.hh"
+
+#include "G4GenericMessenger.hh"
+#include "Randomize.hh"
+#include "CLHEP/Random/MixMaxRng.h"
+#include "CLHEP/Random/MTwistEngine.h"
+#include "CLHEP/Random/Ranlux64Engine.h"
+#include "CLHEP/Random/RanluxppEngine.h"
+
+namespace B1
+{
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+RandomEngineSelector::RandomEngineSelector()
+{
+  DefineCommands();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+RandomEngineSelector::~RandomEngineSelector()
+{
+  delete fMessenger;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+const G4String& RandomEngineSelector::GetEngineNames()
+{
+  static const G4String names = "mixmax ranlux64 ranluxpp mtwist philox";
+  return names;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+CLHEP::HepRandomEngine* RandomEngineSelector::CreateEngine(const G4String& name)
+{
+  if (name == "mixmax") return new CLHEP::MixMaxRng;
+  if (name == "ranlux64") return new CLHEP::Ranlux64Engine;
+  if (name == "ranluxpp") return new CLHEP::RanluxppEngine;
+  if (name == "mtwist") return new CLHEP::MTwistEngine;
+  if (name == "philox") return new PhiloxEngine;
+  return nullptr;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void RandomEngineSelector::SetEngine(const G4String& name)
+{
+  // the worker engines of the Philox type are made by WorkerInitialization
+  std::unique_ptr<CLHEP::HepRandomEngine> engine(CreateEngine(name));
+  if (!engine) return;
+
+  G4Random::setTheEngine(engine.get());
+  fEngine = std::move(engine);
+  G4cout << "Random engine: " << fEngine->name() << G4endl;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void RandomEngineSelector::DefineCommands()
+{
+  fMessenger = new G4GenericMessenger(this, "/b1/random/",
+                                      "Random engine selection");
+
+  fMessenger->DeclareMethod("engine", &RandomEngineSelector::SetEngine,
+                            "Install a new random engine in the master; "
+                            "set the seeds afterwards.")
+    .SetParameterName("engine", false)
+    .SetCandidates(GetEngineNames())
+    .SetStates(G4State_PreInit)
+    .SetToBeBroadcasted(false);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+}
@@ -42,6 +42,11 @@
 #include "G4AnalysisManager.hh"
 //#include "Analysis.hh"
 
+#include <algorithm>
+#include <iomanip>
+#include <istream>
+#include <ostream>
+
 namespace B1
 {
 
@@ -64,33 +69,37 @@ RunAction::RunAction()
   // Register accumulable to the accumulable manager
   G4AccumulableManager* accumulableManager = G4AccumulableManager::Instance();
   accumulableManager->RegisterAccumulable(fEdep);
-  accumulableManager->RegisterAccumulable(fEdep2);
+  accumulableManager->RegisterAccumulable(fEmptyEvents);
+  accumulableManager->RegisterAccumulable(&fEdepPerEvent);
 
   auto analysisManager = G4AnalysisManager::Instance();
   analysisManager->SetVerboseLevel(2);
-  analysisManager->SetNtupleMerging(true);
+  // ntuple merging is set by OutputWriter, see /b1/output/mergeNtuples
 
-  analysisManager->CreateH1("fEdep","Edep",200,0.,5*MeV);
-  analysisManager->CreateH1("PKA_E","PKA_E",200,0.,300*keV);
-  analysisManager->CreateH1("SKA_E","SKA_E",200,0.,300*keV);
-  analysisManager->CreateH1("PKA_length","PKA_length",200,0.,400*nm);
-  analysisManager->CreateH1("SKA_length","SKA_length",200,0.,400*nm);
+  // fEdep, PKA_E, SKA_E, PKA_length, SKA_length; see HistogramSet
+  fHistograms.Book();
 
   //创造一个一维直方图，名称维fEdep，标题维Edep，200个bins，横坐标范围0，10，单位是MeV
-  analysisManager->CreateNtuple("Mydata","Energy deposit");
-  analysisManager->CreateNtupleDColumn("fEdep");
-  analysisManager->CreateNtupleDColumn("x_pos");
-  analysisManager->CreateNtupleDColumn("y_pos");
-  analysisManager->CreateNtupleDColumn("z_pos");
-  analysisManager->CreateNtupleDColumn("PKA_E");
-  analysisManager->CreateNtupleDColumn("SKA_E");
-  analysisManager->CreateNtupleDColumn("PKA_length");
-  analysisManager->CreateNtupleDColumn("SKA_length");
-  analysisManager->CreateNtupleIColumn("TrackID");
-
-  analysisManager->FinishNtuple();
+  // booked through the output, which keeps the columns for the csv rows
+  // of the asynchronous mode
+  fOutput.CreateNtuple("Mydata","Energy deposit");
+  fOutput.CreateNtupleDColumn("fEdep");
+  fOutput.CreateNtupleDColumn("x_pos");
+  fOutput.CreateNtupleDColumn("y_pos");
+  fOutput.CreateNtupleDColumn("z_pos");
+  fOutput.CreateNtupleDColumn("PKA_E");
+  fOutput.CreateNtupleDColumn("SKA_E");
+  fOutput.CreateNtupleDColumn("PKA_length");
+  fOutput.CreateNtupleDColumn("SKA_length");
+  fOutput.CreateNtupleIColumn("TrackID");
+  fOutput.CreateNtupleIColumn("CopyNo");
+
+  fOutput.FinishNtuple();
   //"Mydata"：Ntuple 的名称，用于在输出文件中标识和检索 Ntuple,"Energy deposit"：Ntuple 的标题，用于描述 Ntuple 的内容或目的
   //
+
+  // one row per recoil cluster, filled when /b1/cascade/enable is set
+  fCascadeFinder.Book(fOutput);
 }
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -100,7 +109,7 @@ RunAction::~RunAction()
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
-void RunAction::BeginOfRunAction(const G4Run*)
+void RunAction::BeginOfRunAction(const G4Run* run)
 {
   // inform the runManager to save random number seed
   G4RunManager::GetRunManager()->SetRandomNumberStore(false);
@@ -108,13 +117,26 @@ void RunAction::BeginOfRunAction(const G4Run*)
   // reset accumulables to their initial values
   G4AccumulableManager* accumulableManager = G4AccumulableManager::Instance();
   accumulableManager->Reset();
+  fStatistics.BeginOfRun(IsMaster());
+  fProfiler.BeginOfRun();
+  // a resumed run appends to the phase-space part file of the checkpoint
+  fPhaseSpaceRecorder.BeginOfRun(fCheckpoint.IsResuming());
+  fPrecisionTarget.BeginOfRun(IsMaster());
 
-  auto analysisManager = G4AnalysisManager::Instance();
- // analysisManager->SetDefaultFileType("root");
-  G4String fileName = "Mydata.root";
-// G4String fileName_1 = "Step_position";
-  analysisManager->OpenFile(fileName);
-  G4cout << "Using" << analysisManager->GetType() << G4endl;
+  const auto detConstruction = static_cast<const DetectorConstruction*>(
+    G4RunManager::GetRunManager()->GetUserDetectorConstruction());
+  fHistograms.BeginOfRun(fOutput, *detConstruction);
+
+  // opens the output file, see /b1/output/format and /b1/output/file
+  fOutput.BeginOfRun();
+  G4cout << "Using" << G4AnalysisManager::Instance()->GetType() << G4endl;
+
+  // restores a resumed run, after all the above is reset
+  fCheckpoint.BeginOfRun(run);
+  fSnapshot.BeginOfRun(IsMaster());
+
+  // in asynchronous mode, the writer opens the csv files of the rows
+  fOutput.StartWriter();
 
 //  analysisManager->OpenFile(fileName_1);
 
@@ -122,7 +144,7 @@ void RunAction::BeginOfRunAction(const G4Run*)
 }
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
-void RunAction::SetPrimaryGenerator(const B1::PrimaryGeneratorAction* gen) {
+void RunAction::SetPrimaryGenerator(B1::PrimaryGeneratorAction* gen) {
   fPrimaryGenerator = gen;
 }
 void RunAction::SetPhysicsListName(const G4String& name) {
@@ -130,26 +152,34 @@ void RunAction::SetPhysicsListName(const G4String& name) {
 }
 void RunAction::EndOfRunAction(const G4Run* run)
 {
-  G4int nofEvents = run->GetNumberOfEvent();
+  // hands the last rows to the asynchronous writer
+  fOutput.EndOfRun();
+  fPhaseSpaceRecorder.EndOfRun(IsMaster());
+  fSnapshot.EndOfRun(IsMaster());
+  fPrecisionTarget.EndOfRun(IsMaster());
+
+  // the events of a resumed run include those before the checkpoint
+  G4int nofEvents = run->GetNumberOfEvent() + fCheckpoint.GetResumedEvents();
   if (nofEvents == 0) return;
   
-   auto analysisManager = G4AnalysisManager::Instance();
   // Merge accumulables
+  fStatistics.EndOfRun();
+  fProfiler.EndOfRun();
   G4AccumulableManager* accumulableManager = G4AccumulableManager::Instance();
   accumulableManager->Merge();
+  fHistograms.EndOfRun(IsMaster());
 
   // Compute dose = total energy deposit in a run and its variance
   //
   G4double edep  = fEdep.GetValue();
-  G4double edep2 = fEdep2.GetValue();
 
-  G4double rms = edep2 - edep*edep/nofEvents;
-  if (rms > 0.) rms = std::sqrt(rms); else rms = 0.;
+  // square root of the summed squared deviations, from Welford's moments
+  G4double rms = std::sqrt(std::max(fEdepPerEvent.GetSumSquaredDeviations(), 0.));
 
   const DetectorConstruction* detConstruction
    = static_cast<const DetectorConstruction*>
      (G4RunManager::GetRunManager()->GetUserDetectorConstruction());
-  G4double mass = detConstruction->GetScoringVolume()->GetMass();
+  G4double mass = detConstruction->GetScoringMass();
   G4double dose = edep/mass;
   G4double rmsDose = rms/mass;
 
@@ -189,6 +219,18 @@ void RunAction::EndOfRunAction(const G4Run* run)
      << " Cumulated dose per run, in scoring volume : "
      << G4BestUnit(dose,"Dose") << " rms = " << G4BestUnit(rmsDose,"Dose")
      << G4endl
+     << " Energy deposit per event : mean = "
+     << G4BestUnit(fEdepPerEvent.GetMean(),"Energy")
+     << " rms = " << G4BestUnit(std::sqrt(fEdepPerEvent.GetVariance()),"Energy")
+     << G4endl
+     << "   median = " << G4BestUnit(fEdepPerEvent.GetQuantile(0.50),"Energy")
+     << " 95% = " << G4BestUnit(fEdepPerEvent.GetQuantile(0.95),"Energy")
+     << " 99% = " << G4BestUnit(fEdepPerEvent.GetQuantile(0.99),"Energy")
+     << " max = " << G4BestUnit(fEdepPerEvent.GetMax(),"Energy")
+     << G4endl
+     << " Empty events (no deposit, no recoil) : "
+     << fEmptyEvents.GetValue() << " of " << nofEvents
+     << G4endl
      << "------------------------------------------------------------"
      << G4endl
      << G4endl;
@@ -201,15 +243,48 @@ void RunAction::EndOfRunAction(const G4Run* run)
     for (size_t i = 0; i < 3 && i < energies.size(); ++i) {
       G4cout << "Primary " << i + 1 << " Energy: " << energies[i] / MeV << " MeV" << G4endl;
     }
-    G4cout << "Total Primary Particles: " << run->GetNumberOfEvent() << G4endl;
+    G4cout << "Total Primary Particles: " << nofEvents << G4endl;
     G4cout << "Physics List: " << fPhysicsListName << G4endl;
   }
 
  // G4cout << "Physics List: QGSP_INCLXX_HP" << G4endl;  // 你如果有多个可以后期替换为动态方式
   G4cout << "### ==================================" << G4endl;
 
-  analysisManager->Write();
-  analysisManager->CloseFile();
+  if (IsMaster()) {
+    fStatistics.Print();
+    fProfiler.Print();
+  }
+
+  fOutput.WriteFile();
+  fCheckpoint.EndOfRun(run);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void RunAction::Save(std::ostream& out) const
+{
+  out << std::setprecision(17) << fEdep.GetValue() << '\n';
+  out << fEmptyEvents.GetValue() << '\n';
+  fEdepPerEvent.Save(out);
+  fHistograms.Save(out);
+  fStatistics.Save(out);
+  fPrecisionTarget.Save(out);
+  if (fPrimaryGenerator) fPrimaryGenerator->Save(out);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool RunAction::Restore(std::istream& in)
+{
+  G4double edep = 0.;
+  G4long emptyEvents = 0;
+  in >> edep >> emptyEvents;
+  if (!in) return false;
+  fEdep = edep;
+  fEmptyEvents = emptyEvents;
+  return fEdepPerEvent.Restore(in) && fHistograms.Restore(in)
+         && fStatistics.Restore(in) && fPrecisionTarget.Restore(in)
+         && (!fPrimaryGenerator || fPrimaryGenerator->Restore(in));
 }
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -218,7 +293,7 @@ void RunAction::AddEdep(G4double edep)
 {
 
   fEdep  += edep;
-  fEdep2 += edep*edep;
+  fEdepPerEvent.Fill(edep);
 }
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
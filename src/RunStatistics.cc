@@ -0,0 +1,307 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file RunStatistics.cc
+/// \brief Implementation of the B1::RunStatistics class
+
+#include "RunStatistics.hh"
+
+#include "G4AccumulableManager.hh"
+#include "G4AutoLock.hh"
+#include "G4GenericMessenger.hh"
+#include "G4Threading.hh"
+#include "G4UnitsTable.hh"
+#include "G4SystemOfUnits.hh"
+
+#include <algorithm>
+#include <iomanip>
+#include <istream>
+#include <mutex>
+#include <ostream>
+#include <vector>
+
+namespace
+{
+  // busy time of each worker in the last run, for the idle time report
+  struct ThreadLoad
+  {
+    G4int thread;
+    G4long events;
+    G4double busy;
+  };
+  std::vector<ThreadLoad> threadLoads;
+  G4Mutex threadLoadMutex = G4MUTEX_INITIALIZER;
+}
+
+namespace B1
+{
+
+std::atomic<G4long> RunStatistics::fgTotalEvents{0};
+std::atomic<G4long> RunStatistics::fgTotalSteps{0};
+RunStatistics::Clock::time_point RunStatistics::fgRunStart;
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+RunStatistics::RunStatistics()
+{
+  G4AccumulableManager* accumulableManager = G4AccumulableManager::Instance();
+  accumulableManager->RegisterAccumulable(fEvents);
+  accumulableManager->RegisterAccumulable(fSteps);
+  accumulableManager->RegisterAccumulable(fScoringSteps);
+  accumulableManager->RegisterAccumulable(fRecoils);
+  accumulableManager->RegisterAccumulable(fNtupleRows);
+  accumulableManager->RegisterAccumulable(fEventTimeSum);
+
+  DefineCommands();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+RunStatistics::~RunStatistics()
+{
+  delete fMessenger;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void RunStatistics::BeginOfRun(G4bool isMaster)
+{
+  // the master begins the run before the workers are started
+  if (isMaster) {
+    fgTotalEvents = 0;
+    fgTotalSteps = 0;
+    fgRunStart = Clock::now();
+    G4AutoLock lock(&threadLoadMutex);
+    threadLoads.clear();
+  }
+  fIsMaster = isMaster;
+
+  fNofEvents = 0;
+  fNofSteps = 0;
+  fNofScoringSteps = 0;
+  fNofRecoils = 0;
+  fNofNtupleRows = 0;
+  fNofStepsPublished = 0;
+  fEventTime = 0.;
+  fRunTime = 0.;
+  fRestoredRunTime = 0.;
+  fRunStart = Clock::now();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void RunStatistics::EndOfRun()
+{
+  // must be called before the accumulables are merged
+  fRunTime = fRestoredRunTime + Elapsed(fRunStart);
+
+  fEvents       += fNofEvents;
+  fSteps        += fNofSteps;
+  fScoringSteps += fNofScoringSteps;
+  fRecoils      += fNofRecoils;
+  fNtupleRows   += fNofNtupleRows;
+  fEventTimeSum += fEventTime;
+
+  if (!fIsMaster && fEnabled) {
+    G4AutoLock lock(&threadLoadMutex);
+    threadLoads.push_back({ G4Threading::G4GetThreadId(), fNofEvents, fEventTime });
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void RunStatistics::Save(std::ostream& out) const
+{
+  out << std::setprecision(17)
+      << fNofEvents << ' ' << fNofSteps << ' ' << fNofScoringSteps << ' '
+      << fNofRecoils << ' ' << fNofNtupleRows << ' ' << fEventTime << ' '
+      << fRestoredRunTime + Elapsed(fRunStart) << '\n';
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool RunStatistics::Restore(std::istream& in)
+{
+  in >> fNofEvents >> fNofSteps >> fNofScoringSteps >> fNofRecoils
+     >> fNofNtupleRows >> fEventTime >> fRestoredRunTime;
+  fNofStepsPublished = fNofSteps;
+  return bool(in);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void RunStatistics::BeginOfEvent()
+{
+  if (fEnabled) fEventStart = Clock::now();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void RunStatistics::EndOfEvent()
+{
+  if (!fEnabled) return;
+
+  ++fNofEvents;
+  fEventTime += Elapsed(fEventStart);
+
+  fgTotalEvents.fetch_add(1, std::memory_order_relaxed);
+  fgTotalSteps.fetch_add(fNofSteps - fNofStepsPublished,
+                         std::memory_order_relaxed);
+  fNofStepsPublished = fNofSteps;
+
+  if (fPrintInterval > 0 && fNofEvents % fPrintInterval == 0) PrintProgress();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4double RunStatistics::Elapsed(Clock::time_point start) const
+{
+  return std::chrono::duration<G4double>(Clock::now() - start).count() * s;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void RunStatistics::PrintProgress() const
+{
+  G4double elapsed = Elapsed(fRunStart) / s;
+  G4double totalElapsed = Elapsed(fgRunStart) / s;
+  if (elapsed <= 0. || totalElapsed <= 0.) return;
+
+  G4cout
+    << "B1Stats [thread " << G4Threading::G4GetThreadId() << "] "
+    << fNofEvents << " events: "
+    << fNofEvents / elapsed << " events/s, "
+    << fNofSteps / elapsed << " steps/s"
+    << " | all threads " << fgTotalEvents.load() << " events: "
+    << fgTotalEvents.load() / totalElapsed << " events/s, "
+    << fgTotalSteps.load() / totalElapsed << " steps/s"
+    << G4endl;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void RunStatistics::Print()
+{
+  // Merged values of the last run; the run time is the wall time of this
+  // thread, i.e. of the whole run on the master.
+  G4double nofEvents = fEvents.GetValue();
+  G4double nofSteps = fSteps.GetValue();
+
+  G4cout
+    << G4endl
+    << "--------------------Run Statistics--------------------------"
+    << G4endl;
+
+  if (!fEnabled) {
+    G4cout << " Counters are disabled (/b1/stats/enable true)" << G4endl;
+  }
+
+  G4cout
+    << " Events                : " << nofEvents << G4endl
+    << " Steps                 : " << nofSteps
+    << " (in scoring volume: " << fScoringSteps.GetValue() << ")" << G4endl
+    << " Recoils recorded      : " << fRecoils.GetValue() << G4endl
+    << " Ntuple rows           : " << fNtupleRows.GetValue() << G4endl
+    << " Wall time             : " << G4BestUnit(fRunTime, "Time") << G4endl;
+
+  if (nofEvents > 0.) {
+    G4cout
+      << " Mean event time       : "
+      << G4BestUnit(fEventTimeSum.GetValue() / nofEvents, "Time") << G4endl
+      << " Steps per event       : " << nofSteps / nofEvents << G4endl;
+  }
+  if (fRunTime > 0.) {
+    G4cout
+      << " Throughput            : "
+      << nofEvents / (fRunTime / s) << " events/s, "
+      << nofSteps / (fRunTime / s) << " steps/s" << G4endl;
+  }
+
+  PrintThreadLoads();
+
+  G4cout
+    << "------------------------------------------------------------"
+    << G4endl;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void RunStatistics::PrintThreadLoads() const
+{
+  // A worker is idle when it waits for work or for the other workers at the
+  // end of the run: the wall time of the run minus the time in its events.
+  G4AutoLock lock(&threadLoadMutex);
+  if (!fIsMaster || threadLoads.empty() || fRunTime <= 0.) return;
+
+  auto loads = threadLoads;
+  lock.unlock();
+  std::sort(loads.begin(), loads.end(),
+            [](const ThreadLoad& a, const ThreadLoad& b) { return a.thread < b.thread; });
+
+  G4cout << " Worker load           : thread, events, busy, idle" << G4endl;
+  G4double idleSum = 0.;
+  for (const auto& load : loads) {
+    G4double idle = std::max(fRunTime - load.busy, 0.);
+    idleSum += idle;
+    G4cout
+      << "   " << std::setw(4) << load.thread << std::setw(10) << load.events
+      << "  " << G4BestUnit(load.busy, "Time")
+      << "  " << G4BestUnit(idle, "Time")
+      << " (" << std::setprecision(3) << 100. * idle / fRunTime << " %)"
+      << std::setprecision(6) << G4endl;
+  }
+  G4cout
+    << " Idle fraction         : "
+    << std::setprecision(3) << 100. * idleSum / (fRunTime * loads.size())
+    << " % of " << loads.size() << " workers" << std::setprecision(6) << G4endl;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void RunStatistics::DefineCommands()
+{
+  fMessenger = new G4GenericMessenger(this, "/b1/stats/",
+                                      "Throughput counters of the user actions");
+
+  fMessenger->DeclareProperty("enable", fEnabled,
+                              "Enable or disable the per-thread counters.")
+    .SetParameterName("enable", true)
+    .SetDefaultValue("true");
+
+  fMessenger->DeclareProperty("printInterval", fPrintInterval,
+                              "Print the rates of each thread every N events "
+                              "(0 = never).")
+    .SetParameterName("N", false)
+    .SetRange("N>=0");
+
+  fMessenger->DeclareMethod("print", &RunStatistics::Print,
+                            "Print the counters and rates of the last run.")
+    .SetToBeBroadcasted(false);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+}
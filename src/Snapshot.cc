@@ -0,0 +1,240 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file Snapshot.cc
+/// \brief Implementation of the B1::Snapshot class
+
+#include "Snapshot.hh"
+#include "HistogramIO.hh"
+#include "LogHistogram.hh"
+#include "RunAction.hh"
+
+#include "G4AnalysisManager.hh"
+#include "G4AutoLock.hh"
+#include "G4GenericMessenger.hh"
+#include "G4SystemOfUnits.hh"
+#include "G4Threading.hh"
+
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <sstream>
+#include <vector>
+
+namespace B1
+{
+
+namespace
+{
+  // latest publication of a thread
+  struct Slot
+  {
+    G4long nofEvents = 0;
+    G4double edep = 0.;
+    std::vector<HistogramIO::H1Bins> h1s;
+    std::vector<LogHistogram> logHistograms;
+  };
+
+  G4Mutex snapshotMutex = G4MUTEX_INITIALIZER;
+  std::map<G4int, Slot> slots;
+  std::chrono::steady_clock::time_point runStart;
+  std::chrono::steady_clock::time_point lastWrite;
+  G4bool writing = false;
+
+  void WriteSlot(std::ostream& out, const Slot& slot, G4int nofThreads,
+                 G4double elapsed)
+  {
+    out << std::setprecision(17)
+        << "B1Snapshot\n"
+        << "time " << elapsed << '\n'
+        << "threads " << nofThreads << '\n'
+        << "events " << slot.nofEvents << '\n'
+        << "edep " << slot.edep / MeV << '\n'
+        << "histograms " << slot.h1s.size() << '\n';
+    for (const auto& bins : slot.h1s) HistogramIO::Write(out, bins);
+
+    out << "logHistograms " << slot.logHistograms.size() << '\n';
+    for (const auto& histogram : slot.logHistograms) {
+      std::vector<G4double> edges = histogram.GetEdges();
+      out << "log " << histogram.GetName() << ' ' << histogram.GetNbins()
+          << ' ' << histogram.GetUnderflow() << '\n';
+      for (G4int bin = 0; bin < histogram.GetNbins(); ++bin) {
+        out << edges[bin] << ' ' << edges[bin + 1] << ' '
+            << histogram.GetBinContent(bin) << '\n';
+      }
+    }
+    out << "end\n";
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+Snapshot::Snapshot(RunAction* runAction)
+: fRunAction(runAction)
+{
+  DefineCommands();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+Snapshot::~Snapshot()
+{
+  delete fMessenger;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void Snapshot::BeginOfRun(G4bool isMaster)
+{
+  fActive = fInterval > 0.;
+  fNofEvents = 0;
+  fLastPublish = Clock::now();
+
+  // the master begins the run before the workers are started
+  if (isMaster) {
+    G4AutoLock lock(&snapshotMutex);
+    slots.clear();
+    runStart = fLastPublish;
+    lastWrite = fLastPublish;
+    writing = false;
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void Snapshot::EndOfEvent()
+{
+  if (!fActive) return;
+
+  ++fNofEvents;
+  auto now = Clock::now();
+  if (now - fLastPublish < std::chrono::duration<G4double>(fInterval / s)) {
+    return;
+  }
+  fLastPublish = now;
+  Publish();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void Snapshot::EndOfRun(G4bool isMaster)
+{
+  if (!isMaster) return;
+
+  G4AutoLock lock(&snapshotMutex);
+  slots.clear();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void Snapshot::Publish()
+{
+  Slot slot;
+  slot.nofEvents = fNofEvents;
+  slot.edep = fRunAction->GetEdep();
+  G4int nofH1s = G4AnalysisManager::Instance()->GetNofH1s();
+  for (G4int id = 0; id < nofH1s; ++id) {
+    slot.h1s.push_back(HistogramIO::GetH1(id));
+  }
+  for (auto histogram : fRunAction->GetHistograms().GetAutoHistograms()) {
+    slot.logHistograms.push_back(*histogram);
+  }
+
+  // sum the latest publications of all threads if the file is due
+  Slot merged;
+  G4int nofThreads = 0;
+  G4double elapsed = 0.;
+  {
+    G4AutoLock lock(&snapshotMutex);
+    slots[G4Threading::G4GetThreadId()] = std::move(slot);
+
+    auto now = Clock::now();
+    if (writing
+        || now - lastWrite < std::chrono::duration<G4double>(fInterval / s)) {
+      return;
+    }
+    writing = true;
+    lastWrite = now;
+    elapsed = std::chrono::duration<G4double>(now - runStart).count();
+
+    for (const auto& entry : slots) {
+      const Slot& published = entry.second;
+      if (nofThreads++ == 0) {
+        merged = published;
+        continue;
+      }
+      merged.nofEvents += published.nofEvents;
+      merged.edep += published.edep;
+      for (std::size_t i = 0; i < merged.h1s.size(); ++i) {
+        merged.h1s[i].Add(published.h1s[i]);
+      }
+      for (std::size_t i = 0; i < merged.logHistograms.size(); ++i) {
+        merged.logHistograms[i].Merge(published.logHistograms[i]);
+      }
+    }
+  }
+
+  std::ostringstream out;
+  WriteSlot(out, merged, nofThreads, elapsed);
+
+  // a reader sees either the previous snapshot or this one
+  G4String tmpName = fFileName + ".tmp";
+  std::ofstream file(tmpName, std::ios::trunc);
+  file << out.str();
+  file.close();
+  if (!file || std::rename(tmpName.c_str(), fFileName.c_str()) != 0) {
+    G4ExceptionDescription msg;
+    msg << "Snapshot " << fFileName << " cannot be written.";
+    G4Exception("Snapshot::Publish()", "MyCode0006", JustWarning, msg);
+  }
+
+  G4AutoLock lock(&snapshotMutex);
+  writing = false;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void Snapshot::DefineCommands()
+{
+  fMessenger = new G4GenericMessenger(this, "/b1/snapshot/",
+                                      "Snapshots of the running histograms");
+
+  fMessenger->DeclarePropertyWithUnit("interval", "s", fInterval,
+                                      "Wall time between two snapshots "
+                                      "(0: none).")
+    .SetParameterName("T", false)
+    .SetRange("T>=0.")
+    .SetStates(G4State_PreInit, G4State_Idle);
+
+  fMessenger->DeclareProperty("file", fFileName,
+                              "Name of the snapshot file.")
+    .SetStates(G4State_PreInit, G4State_Idle);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+}
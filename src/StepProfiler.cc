@@ -0,0 +1,223 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file StepProfiler.cc
+/// \brief Implementation of the B1::StepProfiler class
+
+#include "StepProfiler.hh"
+
+#include "G4AutoLock.hh"
+#include "G4GenericMessenger.hh"
+#include "G4LogicalVolume.hh"
+#include "G4ParticleDefinition.hh"
+#include "G4Step.hh"
+#include "G4StepPoint.hh"
+#include "G4Track.hh"
+#include "G4VProcess.hh"
+
+#include <algorithm>
+#include <iomanip>
+#include <map>
+#include <tuple>
+#include <vector>
+
+namespace
+{
+  // Buckets of all threads, merged by name at the end of the run
+  struct MergedBucket
+  {
+    G4double steps = 0.;
+    G4double seconds = 0.;
+  };
+  using MergedKey = std::tuple<G4String, G4String, G4String>;
+
+  G4Mutex profilerMutex = G4MUTEX_INITIALIZER;
+  std::map<MergedKey, MergedBucket> mergedBuckets;
+}
+
+namespace B1
+{
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+StepProfiler::StepProfiler()
+{
+  DefineCommands();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+StepProfiler::~StepProfiler()
+{
+  delete fMessenger;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void StepProfiler::BeginOfRun()
+{
+  fBuckets.clear();
+  fLastBucket = nullptr;
+  fCountdown = fSampling;
+  fRunStart = std::chrono::steady_clock::now();
+  fRunStartTicks = ReadTicks();
+  fLastTicks = fRunStartTicks;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void StepProfiler::Step(const G4Step* step, const G4LogicalVolume* volume)
+{
+  std::uint64_t now = ReadTicks();
+  if (--fCountdown > 0) {
+    fLastTicks = now;
+    return;
+  }
+  fCountdown = fSampling;
+
+  Key key = { volume, step->GetTrack()->GetDefinition(),
+              step->GetPostStepPoint()->GetProcessDefinedStep() };
+  if (!fLastBucket || !(key == fLastKey)) {
+    fLastBucket = &fBuckets[key];
+    fLastKey = key;
+  }
+  fLastBucket->steps += 1.;
+  fLastBucket->ticks += static_cast<G4double>(now - fLastTicks);
+  fLastTicks = now;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void StepProfiler::EndOfRun()
+{
+  if (fBuckets.empty()) return;
+
+  // calibrate the cycle counter against the wall clock of this run
+  G4double seconds = std::chrono::duration<G4double>(
+    std::chrono::steady_clock::now() - fRunStart).count();
+  G4double ticks = static_cast<G4double>(ReadTicks() - fRunStartTicks);
+  G4double secondsPerTick = (ticks > 0.) ? seconds / ticks : 0.;
+
+  G4AutoLock lock(&profilerMutex);
+  for (const auto& [key, bucket] : fBuckets) {
+    MergedKey name(
+      key.volume ? key.volume->GetName() : G4String("none"),
+      key.particle ? key.particle->GetParticleName() : G4String("none"),
+      key.process ? key.process->GetProcessName() : G4String("none"));
+    auto& merged = mergedBuckets[name];
+    merged.steps += bucket.steps * fSampling;
+    merged.seconds += bucket.ticks * secondsPerTick * fSampling;
+  }
+  fBuckets.clear();
+  fLastBucket = nullptr;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void StepProfiler::Print()
+{
+  std::vector<std::pair<MergedKey, MergedBucket>> rows;
+  {
+    G4AutoLock lock(&profilerMutex);
+    rows.assign(mergedBuckets.begin(), mergedBuckets.end());
+    mergedBuckets.clear();
+  }
+  if (rows.empty()) return;
+
+  std::sort(rows.begin(), rows.end(),
+            [](const auto& a, const auto& b)
+            { return a.second.seconds > b.second.seconds; });
+
+  G4double totalSteps = 0.;
+  G4double totalSeconds = 0.;
+  for (const auto& row : rows) {
+    totalSteps += row.second.steps;
+    totalSeconds += row.second.seconds;
+  }
+
+  G4cout
+    << G4endl
+    << "--------------------Step Profile----------------------------"
+    << G4endl
+    << " sampling 1/" << fSampling << ", " << totalSteps << " steps, "
+    << totalSeconds << " s of stepping (summed over threads)" << G4endl
+    << std::left
+    << " " << std::setw(12) << "Volume" << std::setw(12) << "Particle"
+    << std::setw(22) << "Process" << std::right
+    << std::setw(12) << "Steps" << std::setw(12) << "Time [s]"
+    << std::setw(8) << "Share" << std::setw(12) << "ns/step" << G4endl;
+
+  G4int nRows = 0;
+  for (const auto& [key, bucket] : rows) {
+    if (nRows++ == fMaxRows) {
+      G4cout << " ... " << rows.size() - fMaxRows << " more buckets" << G4endl;
+      break;
+    }
+    G4double share = (totalSeconds > 0.) ? 100. * bucket.seconds / totalSeconds : 0.;
+    G4double perStep = (bucket.steps > 0.) ? 1.e9 * bucket.seconds / bucket.steps : 0.;
+    G4cout
+      << std::left
+      << " " << std::setw(12) << std::get<0>(key)
+      << std::setw(12) << std::get<1>(key)
+      << std::setw(22) << std::get<2>(key) << std::right
+      << std::setw(12) << std::setprecision(6) << bucket.steps
+      << std::setw(12) << std::setprecision(4) << bucket.seconds
+      << std::setw(7) << std::setprecision(3) << share << "%"
+      << std::setw(12) << std::setprecision(4) << perStep << G4endl;
+  }
+  G4cout
+    << std::setprecision(6)
+    << "------------------------------------------------------------"
+    << G4endl;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void StepProfiler::DefineCommands()
+{
+  fMessenger = new G4GenericMessenger(this, "/b1/profile/",
+                                      "Step-time profiler of the tracking");
+
+  fMessenger->DeclareProperty("enable", fEnabled,
+                              "Charge the step times to (volume, particle, "
+                              "process) buckets and print them at end of run.")
+    .SetParameterName("enable", true)
+    .SetDefaultValue("true");
+
+  fMessenger->DeclareProperty("sampling", fSampling,
+                              "Charge only one step in N to the buckets.")
+    .SetParameterName("N", false)
+    .SetRange("N>=1");
+
+  fMessenger->DeclareProperty("maxRows", fMaxRows,
+                              "Maximum number of buckets in the report.")
+    .SetParameterName("rows", false)
+    .SetRange("rows>=1");
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+}
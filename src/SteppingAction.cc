@@ -29,6 +29,7 @@
 
 #include "SteppingAction.hh"
 #include "EventAction.hh"
+#include "RunAction.hh"
 #include "DetectorConstruction.hh"
 #include <fstream>
 #include <vector>
@@ -50,7 +51,11 @@ namespace B1
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
 SteppingAction::SteppingAction(EventAction* eventAction)
-: fEventAction(eventAction)
+: fEventAction(eventAction),
+  fStatistics(&eventAction->GetRunAction()->GetStatistics()),
+  fProfiler(&eventAction->GetRunAction()->GetProfiler()),
+  fPhaseSpace(&eventAction->GetRunAction()->GetPhaseSpaceRecorder()),
+  fCascadeFinder(&eventAction->GetRunAction()->GetCascadeFinder())
 {}
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -62,103 +67,39 @@ SteppingAction::~SteppingAction()
 
 void SteppingAction::UserSteppingAction(const G4Step* step)
 {
-  if (!fScoringVolume) {
-    const DetectorConstruction* detConstruction
-      = static_cast<const DetectorConstruction*>
-        (G4RunManager::GetRunManager()->GetUserDetectorConstruction());
-    fScoringVolume = detConstruction->GetScoringVolume();
+  if (!fDetector) {
+    fDetector = static_cast<const DetectorConstruction*>
+      (G4RunManager::GetRunManager()->GetUserDetectorConstruction());
   }
+  // read every step, the geometry may be rebuilt between runs
+  G4LogicalVolume* scoringVolume = fDetector->GetScoringVolume();
 
   // get volume of the current step
   G4LogicalVolume* volume
     = step->GetPreStepPoint()->GetTouchableHandle()
       ->GetVolume()->GetLogicalVolume();
 
+  fStatistics->CountStep(volume == scoringVolume);
+  if (fProfiler->IsEnabled()) fProfiler->Step(step, volume);
+  fPhaseSpace->Step(step);
+
   // check if we are in scoring volume
-  if (volume != fScoringVolume) return;
-  //如果presteppoint所在的volume是定义的fScoringVolume则输入数据
-  //
-  if (volume == fScoringVolume){
-	  if (step->IsLastStepInVolume()) {
-    // 粒子飞出了边界
-    // 可以在这里执行相应的操作 
-  G4cout<< " x_boundary: " << step->GetPostStepPoint()->GetPosition().x()/CLHEP::cm <<" cm" << G4endl;
-  G4cout<< " y_boundary: " << step->GetPostStepPoint()->GetPosition().y()/CLHEP::cm <<" cm" << G4endl;
-  G4cout<< " z_boundary: " << step->GetPostStepPoint()->GetPosition().z()/CLHEP::cm <<" cm" << G4endl;
-	  }
-          else{
-  G4cout<< " x_pos: " << step->GetPostStepPoint()->GetPosition().x()/CLHEP::cm <<" cm" << G4endl;
-  G4cout<< " y_pos: " << step->GetPostStepPoint()->GetPosition().y()/CLHEP::cm <<" cm" << G4endl;
-  G4cout<< " z_pos: " << step->GetPostStepPoint()->GetPosition().z()/CLHEP::cm <<" cm" << G4endl;
-  //抓取PKA能谱，飞行距离
-
-  auto analysisManager = G4AnalysisManager::Instance();
-  analysisManager->FillNtupleDColumn(1, step->GetPostStepPoint()->GetPosition().x());
-  analysisManager->FillNtupleDColumn(2, step->GetPostStepPoint()->GetPosition().y());
-  analysisManager->FillNtupleDColumn(3, step->GetPostStepPoint()->GetPosition().z());
-  //抓取PKA能谱，飞行距离
-
-  const G4Track* track = step->GetTrack();
-  if (track->GetTrackID() > 1) {
-
-    // 获取次级粒子的粒子定义
-    const G4ParticleDefinition* particleDefinition = track->GetDefinition();
-
-    // 判断是否为 12C
-    if (particleDefinition->GetParticleName() == "C12") {
-        // 获取次级粒子的能量和轨迹长度
-        G4double secondaryEnergy = track->GetVertexKineticEnergy();
-        G4double trackLength = track->GetTrackLength();
-        G4int trackID = track->GetTrackID();
-
-        auto analysisManager = G4AnalysisManager::Instance();
-        
-        // 填充 ROOT 直方图
-        analysisManager->FillH1(1, secondaryEnergy);
-        analysisManager->FillH1(2, trackLength);
-
-        // 初始化 PKA/SKA 数据（默认为 0）
-        G4double PKA_E = 0.0, SKA_E = 0.0;
-        G4double PKA_length = 0.0, SKA_length = 0.0;
-
-        // 判断是 PKA 还是 SKA
-        if (trackID == 2) {  // PKA
-            PKA_E = secondaryEnergy;
-            PKA_length = trackLength;
-        } else if (trackID > 2) {  // SKA
-            SKA_E = secondaryEnergy;
-            SKA_length = trackLength;
-        }
-
-        // 填充 Ntuple 数据
-        G4cout << "DEBUG: PKA_E = " << PKA_E/ CLHEP::keV << " keV" << " | TrackID = " << trackID << G4endl;
-        analysisManager->FillNtupleDColumn(4, PKA_E);
-        //analysisManager->FillNtupleDColumn(4, 100);
-        analysisManager->FillNtupleDColumn(5, SKA_E);
-        analysisManager->FillNtupleDColumn(6, PKA_length);
-        analysisManager->FillNtupleDColumn(7, SKA_length);
-        analysisManager->FillNtupleIColumn(8, trackID);
-        
-        // 记录输出信息
-        G4cout << "Secondary Particle Energy: " << secondaryEnergy / CLHEP::keV << " keV" << G4endl;
-        G4cout << "Secondary Particle Type: " << particleDefinition->GetParticleName() << G4endl;
-        G4cout << "Track ID: " << trackID << G4endl;
-        
-        
-        analysisManager->AddNtupleRow();
-        
-
-        }
-    }
-
-
-  }  
-  }	 
-
-  // collect energy deposited in this step
-  G4double edepStep = step->GetTotalEnergyDeposit();
-//  G4cout << "edep:" << edepStep / CLHEP::MeV << "MeV" << G4endl;
-  fEventAction->AddEdep(edepStep);
+  if (volume != scoringVolume) return;
+
+  fCascadeFinder->Step(step, fEventAction->GetAncestry());
+
+  // the recoils, their PKA/SKA split and their rows are filled from the
+  // DiamondSD hits at the end of the event; only the printout is left here
+  if (fEventAction->GetVerboseLevel() > 1) {
+    const G4ThreeVector& position = step->GetPostStepPoint()->GetPosition();
+    // boundary: the last step in the volume
+    G4String where = step->IsLastStepInVolume() ? "_boundary: " : "_pos: ";
+    G4cout << " x" << where << position.x() / CLHEP::cm << " cm" << G4endl;
+    G4cout << " y" << where << position.y() / CLHEP::cm << " cm" << G4endl;
+    G4cout << " z" << where << position.z() / CLHEP::cm << " cm" << G4endl;
+  }
+
+  // the energy deposit is collected by the DiamondSD hits
 
 // Get position of step, code from Geant4 forum
 // get the status of the pre step point
@@ -0,0 +1,129 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file VacuumTransportModel.cc
+/// \brief Implementation of the B1::VacuumTransportModel class
+
+#include "VacuumTransportModel.hh"
+
+#include "G4AffineTransform.hh"
+#include "G4FastStep.hh"
+#include "G4FastTrack.hh"
+#include "G4GenericMessenger.hh"
+#include "G4LogicalVolume.hh"
+#include "G4Track.hh"
+#include "G4VPhysicalVolume.hh"
+#include "G4VSolid.hh"
+#include "geomdefs.hh"
+
+namespace B1
+{
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+VacuumTransportModel::VacuumTransportModel(const G4String& name,
+                                           G4Region* envelope)
+: G4VFastSimulationModel(name, envelope)
+{
+  DefineCommands();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+VacuumTransportModel::~VacuumTransportModel()
+{
+  delete fMessenger;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool VacuumTransportModel::ModelTrigger(const G4FastTrack& fastTrack)
+{
+  if (!fEnabled) return false;
+
+  // primaries in the envelope volume itself; the daughters belong to the
+  // same region but are tracked normally
+  const G4Track* track = fastTrack.GetPrimaryTrack();
+  if (track->GetParentID() != 0) return false;
+  if (track->GetVolume() != fastTrack.GetEnvelopePhysicalVolume()) return false;
+
+  G4ThreeVector position = fastTrack.GetPrimaryTrackLocalPosition();
+  G4ThreeVector direction = fastTrack.GetPrimaryTrackLocalDirection();
+
+  fDistance = kInfinity;
+  const G4LogicalVolume* envelope = fastTrack.GetEnvelopeLogicalVolume();
+  for (std::size_t i = 0; i < envelope->GetNoDaughters(); ++i) {
+    const G4VPhysicalVolume* daughter = envelope->GetDaughter(i);
+    G4AffineTransform toDaughter
+      = G4AffineTransform(daughter->GetRotation(), daughter->GetTranslation())
+        .Inverse();
+    G4double distance = daughter->GetLogicalVolume()->GetSolid()->DistanceToIn(
+      toDaughter.TransformPoint(position), toDaughter.TransformAxis(direction));
+    if (distance < fDistance) fDistance = distance;
+  }
+
+  // a track on the surface of a daughter is left to the navigator, which
+  // moves it in; this also avoids zero-length fast steps
+  return fDistance > 0.;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void VacuumTransportModel::DoIt(const G4FastTrack& fastTrack,
+                                G4FastStep& fastStep)
+{
+  if (fDistance == kInfinity) {
+    fastStep.KillPrimaryTrack();
+    return;
+  }
+
+  const G4Track* track = fastTrack.GetPrimaryTrack();
+  G4ThreeVector position = fastTrack.GetPrimaryTrackLocalPosition()
+                           + fDistance * fastTrack.GetPrimaryTrackLocalDirection();
+  fastStep.ProposePrimaryTrackFinalPosition(position);
+  fastStep.ProposePrimaryTrackFinalTime(
+    track->GetGlobalTime() + fDistance / track->GetVelocity());
+  fastStep.ProposePrimaryTrackPathLength(fDistance);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void VacuumTransportModel::DefineCommands()
+{
+  fMessenger = new G4GenericMessenger(this, "/b1/fastsim/",
+                                      "Fast simulation in the envelope");
+
+  fMessenger->DeclareProperty("vacuumTransport", fEnabled,
+                              "Move the primaries through the vacuum "
+                              "envelope in one step to the daughter they "
+                              "hit; kill those that miss.")
+    .SetParameterName("enable", true)
+    .SetDefaultValue("true");
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+}
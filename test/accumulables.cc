@@ -0,0 +1,224 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file accumulables.cc
+/// \brief Unit test of the merge of B1::EdepAccumulable and B1::LogHistogram
+//
+// Fills one accumulable with all values and two others with a share each,
+// merges the shares, also into an empty one, and compares with the single
+// fill: the moments to rounding, the quantile buckets and the histogram
+// bins exactly. Checks that the coarsened LogHistogram equals the binning
+// of the values at the coarse level, and that the quantiles are within the
+// relative accuracy of the sorted values. Returns 0 when all checks pass.
+
+#include "EdepAccumulable.hh"
+#include "LogHistogram.hh"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <map>
+#include <vector>
+
+namespace
+{
+  int failures = 0;
+
+  void Check(bool condition, const char* what)
+  {
+    if (condition) return;
+    std::printf("FAIL: %s\n", what);
+    ++failures;
+  }
+
+  bool Close(double a, double b, double tolerance)
+  {
+    return std::abs(a - b) <= tolerance * std::max(std::abs(a), std::abs(b));
+  }
+
+  // log-uniform values from 10^low to 10^high, with some zeros
+  std::vector<double> Values(int n, double low, double high,
+                             std::uint64_t seed)
+  {
+    std::vector<double> values;
+    std::uint64_t state = seed;
+    for (int i = 0; i < n; ++i) {
+      state ^= state << 13;
+      state ^= state >> 7;
+      state ^= state << 17;
+      double u = double(state >> 11) / double(1ull << 53);
+      values.push_back((i % 50 == 0) ? 0. : std::pow(10., low + u * (high - low)));
+    }
+    return values;
+  }
+
+  const double kQuantiles[] = { 0., 0.01, 0.25, 0.5, 0.95, 0.99, 1. };
+
+  bool SameEdep(const B1::EdepAccumulable& a, const B1::EdepAccumulable& b)
+  {
+    bool same = a.GetCount() == b.GetCount()
+                && Close(a.GetMean(), b.GetMean(), 1.e-12)
+                && Close(a.GetSumSquaredDeviations(),
+                         b.GetSumSquaredDeviations(), 1.e-10)
+                && a.GetMin() == b.GetMin() && a.GetMax() == b.GetMax();
+    for (double q : kQuantiles) same &= a.GetQuantile(q) == b.GetQuantile(q);
+    return same;
+  }
+
+  bool SameHistogram(const B1::LogHistogram& a, const B1::LogHistogram& b)
+  {
+    if (a.GetUnderflow() != b.GetUnderflow() || a.GetNbins() != b.GetNbins()
+        || a.GetEdges() != b.GetEdges()) {
+      return false;
+    }
+    for (G4int i = 0; i < a.GetNbins(); ++i) {
+      if (a.GetBinContent(i) != b.GetBinContent(i)) return false;
+    }
+    return true;
+  }
+
+  // floor(a/2), as the coarsening of the grid index
+  int HalfDown(int a) { return (a >= 0) ? a / 2 : -((1 - a) / 2); }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void TestEdepAccumulable()
+{
+  // 1 keV to 100 MeV, a few below the minimum value of 1 eV (the zeros)
+  auto values = Values(1000, -3., 2., 12345);
+  B1::EdepAccumulable all("all"), first("first"), second("second");
+  for (std::size_t i = 0; i < values.size(); ++i) {
+    all.Fill(values[i]);
+    (i < 300 ? first : second).Fill(values[i]);
+  }
+
+  B1::EdepAccumulable merged("merged");
+  merged.Merge(first);
+  merged.Merge(second);
+  Check(SameEdep(merged, all), "EdepAccumulable: merge of two shares");
+
+  B1::EdepAccumulable empty("empty");
+  first.Merge(empty);
+  empty.Merge(second);
+  first.Merge(empty);
+  Check(SameEdep(first, all), "EdepAccumulable: merge with an empty one");
+
+  // the extremes of an empty one are not values
+  B1::EdepAccumulable positive("positive"), fresh("fresh");
+  for (double value : { 2., 1., 3. }) positive.Fill(value * CLHEP::MeV);
+  fresh.Merge(positive);
+  Check(SameEdep(fresh, positive) && fresh.GetMin() == 1.*CLHEP::MeV,
+        "EdepAccumulable: extremes after a merge into an empty one");
+
+  // the quantiles of the sketch against the sorted values
+  std::sort(values.begin(), values.end());
+  bool accurate = true;
+  for (double q : kQuantiles) {
+    double exact = values[std::size_t(q * (values.size() - 1))];
+    double estimate = all.GetQuantile(q);
+    if (exact < 1.*CLHEP::eV) accurate &= (estimate == 0.);
+    else accurate &= Close(estimate, exact, 0.01 * (1. + 1.e-9));
+  }
+  Check(accurate, "EdepAccumulable: quantiles within the relative accuracy");
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void TestLogHistogram()
+{
+  // 10 bins per decade; at most 16 bins, so 8 decades need level 3
+  const double binsPerDecade = 10.;
+  const G4int maxBins = 16;
+  auto values = Values(2000, -4., 4., 67890);
+
+  B1::LogHistogram all("all", binsPerDecade, maxBins);
+  for (double value : values) all.Fill(value);
+  Check(all.GetNbins() <= maxBins, "LogHistogram: at most maxBins bins");
+
+  // the coarse bins are the unions of the fine ones
+  auto edges = all.GetEdges();
+  double width = std::log10(edges[1] / edges[0]);
+  int level = int(std::lround(std::log2(width * binsPerDecade)));
+  int offset = int(std::lround(std::log10(edges[0]) / width));
+  std::map<int, double> expected;
+  double underflow = 0.;
+  for (double value : values) {
+    if (value <= 0.) {
+      underflow += 1.;
+      continue;
+    }
+    int index = int(std::floor(std::log10(value) / (1. / binsPerDecade)));
+    for (int k = 0; k < level; ++k) index = HalfDown(index);
+    expected[index] += 1.;
+  }
+  bool exact = (level > 0 && all.GetUnderflow() == underflow
+                && expected.begin()->first >= offset
+                && expected.rbegin()->first < offset + all.GetNbins());
+  for (G4int i = 0; exact && i < all.GetNbins(); ++i) {
+    auto found = expected.find(offset + i);
+    double content = (found != expected.end()) ? found->second : 0.;
+    exact &= (all.GetBinContent(i) == content);
+  }
+  Check(exact, "LogHistogram: coarsening keeps every entry in its coarse bin");
+
+  // a narrow share stays at level 0, a wide one is coarsened; the merge in
+  // either order equals the single fill
+  B1::LogHistogram narrow("narrow", binsPerDecade, maxBins);
+  B1::LogHistogram wide("wide", binsPerDecade, maxBins);
+  auto narrowValues = Values(500, 0., 1., 24680);
+  for (double value : narrowValues) narrow.Fill(value);
+  for (double value : values) wide.Fill(value);
+  B1::LogHistogram both("both", binsPerDecade, maxBins);
+  for (double value : narrowValues) both.Fill(value);
+  for (double value : values) both.Fill(value);
+  Check(narrow.GetNbins() <= 10 && narrow.GetEdges()[0] == 1.,
+        "LogHistogram: narrow share stays at the fine level");
+
+  B1::LogHistogram narrowFirst(narrow), wideFirst(wide);
+  narrowFirst.Merge(wide);
+  wideFirst.Merge(narrow);
+  Check(SameHistogram(narrowFirst, both), "LogHistogram: fine merged with coarse");
+  Check(SameHistogram(wideFirst, both), "LogHistogram: coarse merged with fine");
+
+  B1::LogHistogram empty("empty", binsPerDecade, maxBins);
+  empty.Merge(both);
+  Check(SameHistogram(empty, both), "LogHistogram: merge into an empty one");
+  Check(empty.GetEntries() == double(values.size() + narrowValues.size()),
+        "LogHistogram: no entry lost");
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+int main()
+{
+  TestEdepAccumulable();
+  TestLogHistogram();
+
+  if (failures == 0) std::printf("Accumulables: all checks pass\n");
+  return failures == 0 ? 0 : 1;
+}
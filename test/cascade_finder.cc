@@ -0,0 +1,196 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file cascade_finder.cc
+/// \brief Unit test of the clustering of the B1::CascadeFinder
+//
+// Checks two groups of points just inside and just outside the radius of
+// each other, points on the cell boundaries of the hash grid, negative
+// coordinates, the cluster sums, and a random cloud against a brute-force
+// clustering. Returns 0 when all checks pass.
+
+#include "CascadeFinder.hh"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <numeric>
+#include <vector>
+
+namespace
+{
+  int failures = 0;
+
+  void Check(bool condition, const char* what)
+  {
+    if (condition) return;
+    std::printf("FAIL: %s\n", what);
+    ++failures;
+  }
+
+  // number of points of every cluster, sorted
+  std::vector<int> Sizes(B1::CascadeFinder& finder)
+  {
+    std::vector<int> sizes;
+    for (const auto& cluster : finder.FindClusters()) {
+      sizes.push_back(cluster.points);
+    }
+    std::sort(sizes.begin(), sizes.end());
+    return sizes;
+  }
+
+  void Add(B1::CascadeFinder& finder, double x, double y, double z)
+  {
+    finder.AddPoint(G4ThreeVector(x, y, z), 0., false);
+  }
+
+  // clusters of the points by testing every pair, sizes sorted
+  std::vector<int> BruteForce(const std::vector<G4ThreeVector>& points,
+                              double radius)
+  {
+    std::vector<int> parent(points.size());
+    std::iota(parent.begin(), parent.end(), 0);
+    auto root = [&parent](int i) {
+      while (parent[i] != i) i = parent[i];
+      return i;
+    };
+    for (std::size_t i = 0; i < points.size(); ++i) {
+      for (std::size_t j = 0; j < i; ++j) {
+        if ((points[i] - points[j]).mag2() <= radius * radius) {
+          parent[root(int(i))] = root(int(j));
+        }
+      }
+    }
+    std::vector<int> count(points.size(), 0);
+    for (std::size_t i = 0; i < points.size(); ++i) ++count[root(int(i))];
+    std::vector<int> sizes;
+    for (int n : count) {
+      if (n > 0) sizes.push_back(n);
+    }
+    std::sort(sizes.begin(), sizes.end());
+    return sizes;
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+int main()
+{
+  const double r = 5.*CLHEP::nm;
+  B1::CascadeFinder finder;
+  finder.SetRadius(r);
+
+  // two groups of two points; the gap between them is the only link
+  for (double gap : { 0.99 * r, 1.01 * r }) {
+    finder.BeginOfEvent();
+    Add(finder, 0.3 * r, 0.1 * r, 0.2 * r);
+    Add(finder, 0.8 * r, 0.1 * r, 0.2 * r);
+    Add(finder, 0.8 * r + gap, 0.1 * r, 0.2 * r);
+    Add(finder, 1.3 * r + gap, 0.1 * r, 0.2 * r);
+    auto sizes = Sizes(finder);
+    if (gap < r) Check(sizes == std::vector<int>{ 4 }, "groups within the radius join");
+    else Check(sizes == std::vector<int>{ 2, 2 }, "groups beyond the radius stay apart");
+  }
+
+  // points on the cell boundaries (multiples of the radius): a distance of
+  // exactly the radius joins, across cells and along every axis
+  finder.BeginOfEvent();
+  Add(finder, r, 0., 0.);
+  Add(finder, 2. * r, 0., 0.);
+  Add(finder, 2. * r, r, 0.);
+  Add(finder, 2. * r, r, r);
+  Check(Sizes(finder) == std::vector<int>{ 4 }, "points at the radius on cell boundaries join");
+
+  // neighbours on both sides of a boundary, and two points two cells apart
+  // with a distance just over the radius
+  finder.BeginOfEvent();
+  Add(finder, r * (1. - 1.e-9), 0., 0.);
+  Add(finder, r * (1. + 1.e-9), 0., 0.);
+  Add(finder, 3. * r, 3. * r, 3. * r);
+  Add(finder, 4. * r * (1. + 1.e-9), 3. * r, 3. * r);
+  Check(Sizes(finder) == std::vector<int>{ 1, 1, 2 },
+        "a boundary between two cells does not split or join wrongly");
+
+  // negative coordinates: a chain through the cells -3 ... 0 and a lone
+  // point in the negative octant
+  finder.BeginOfEvent();
+  Add(finder, -2.5 * r, -0.1 * r, -0.1 * r);
+  Add(finder, -1.6 * r, -0.1 * r, -0.1 * r);
+  Add(finder, -0.7 * r, -0.1 * r, -0.1 * r);
+  Add(finder, 0.2 * r, 0.1 * r, 0.1 * r);
+  Add(finder, -4. * r, -4. * r, -4. * r);
+  Check(Sizes(finder) == std::vector<int>{ 1, 4 }, "chain through negative cells");
+
+  // cells -1 and 0 on every axis, distance below the radius
+  finder.BeginOfEvent();
+  Add(finder, -0.3 * r, -0.3 * r, -0.3 * r);
+  Add(finder, 0.4 * r, 0., 0.);
+  Check(Sizes(finder) == std::vector<int>{ 2 }, "neighbours across the origin join");
+
+  // the sums of one cluster: recoils are the vertices, the energy is theirs
+  finder.BeginOfEvent();
+  finder.AddPoint(G4ThreeVector(-r, 0., 0.), 2.*CLHEP::MeV, true);
+  finder.AddPoint(G4ThreeVector(0., 0., 0.), 0., false);
+  finder.AddPoint(G4ThreeVector(0., r, 0.), 1.*CLHEP::MeV, true);
+  const auto& clusters = finder.FindClusters();
+  Check(clusters.size() == 1, "one cluster for the sums");
+  if (clusters.size() == 1) {
+    const auto& cluster = clusters[0];
+    Check(cluster.recoils == 2 && cluster.points == 3, "recoils and points counted");
+    Check(cluster.energy == 3.*CLHEP::MeV, "energy of the vertices summed");
+    Check(cluster.min[0] == -r && cluster.max[0] == 0.
+          && cluster.min[1] == 0. && cluster.max[1] == r,
+          "extent of the cluster");
+    Check(cluster.sum[0] == -r && cluster.sum[1] == r, "sum of the positions");
+  }
+
+  // a random cloud around the origin against the brute-force clustering
+  std::vector<G4ThreeVector> cloud;
+  std::uint64_t state = 88172645463325252ull;
+  auto uniform = [&state]() {
+    state ^= state << 13;
+    state ^= state >> 7;
+    state ^= state << 17;
+    return double(state >> 11) / double(1ull << 53);
+  };
+  for (int i = 0; i < 2000; ++i) {
+    cloud.emplace_back((uniform() - 0.5) * 20. * r, (uniform() - 0.5) * 20. * r,
+                       (uniform() - 0.5) * 20. * r);
+  }
+  finder.BeginOfEvent();
+  for (const auto& point : cloud) Add(finder, point.x(), point.y(), point.z());
+  auto sizes = Sizes(finder);
+  Check(sizes == BruteForce(cloud, r), "random cloud matches the brute force");
+  Check(std::accumulate(sizes.begin(), sizes.end(), 0) == int(cloud.size()),
+        "every point in one cluster");
+
+  // an empty event has no clusters
+  finder.BeginOfEvent();
+  Check(finder.FindClusters().empty(), "no clusters without points");
+
+  if (failures == 0) std::printf("CascadeFinder: all checks pass\n");
+  return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,112 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file spsc_queue.cc
+/// \brief Unit test of the B1::SpscQueue class template
+//
+// Checks the capacity rounding, a full and an empty queue, the wraparound
+// of the indices over many cycles and the order of the items passed
+// between two threads. Returns 0 when all checks pass.
+
+#include "SpscQueue.hh"
+
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+namespace
+{
+  int failures = 0;
+
+  void Check(bool condition, const char* what)
+  {
+    if (condition) return;
+    std::printf("FAIL: %s\n", what);
+    ++failures;
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+int main()
+{
+  // the capacity is the next power of two, at least 2
+  Check(B1::SpscQueue<int>(5).Capacity() == 8, "capacity 5 rounded to 8");
+  Check(B1::SpscQueue<int>(8).Capacity() == 8, "capacity 8 kept");
+  Check(B1::SpscQueue<int>(0).Capacity() == 2, "capacity 0 rounded to 2");
+
+  // empty queue
+  B1::SpscQueue<int> queue(4);
+  int out[8] = {};
+  Check(queue.Empty(), "new queue is empty");
+  Check(queue.Pop(out, 8) == 0, "pop from an empty queue");
+
+  // full queue
+  for (int i = 0; i < 4; ++i) Check(queue.Push(i), "push into a free slot");
+  Check(!queue.Push(4), "push into a full queue fails");
+  Check(!queue.Empty(), "full queue is not empty");
+  Check(queue.Pop(out, 3) == 3 && out[0] == 0 && out[2] == 2,
+        "pop at most the requested items, in order");
+  Check(queue.Push(4), "push after a pop");
+  Check(queue.Pop(out, 8) == 2 && out[0] == 3 && out[1] == 4,
+        "pop the rest after the push");
+  Check(queue.Empty() && queue.Pop(out, 8) == 0, "drained queue is empty");
+
+  // wraparound: the indices run far past the capacity; batches of 3 in a
+  // queue of 4 put every item at a different slot in successive cycles
+  int next = 5, expected = 5;
+  bool inOrder = true;
+  for (int cycle = 0; cycle < 1000; ++cycle) {
+    for (int i = 0; i < 3; ++i) inOrder &= queue.Push(next++);
+    std::size_t n = queue.Pop(out, 8);
+    inOrder &= (n == 3);
+    for (std::size_t i = 0; i < n; ++i) inOrder &= (out[i] == expected++);
+  }
+  Check(inOrder, "items keep their order across the wraparound");
+
+  // one producer and one consumer thread; the producer retries when full
+  const int nofItems = 1000000;
+  B1::SpscQueue<int> shared(64);
+  std::thread producer([&shared]() {
+    for (int i = 0; i < nofItems; ++i) {
+      while (!shared.Push(i)) std::this_thread::yield();
+    }
+  });
+  std::vector<int> batch(16);
+  int received = 0;
+  bool threadOrder = true;
+  while (received < nofItems) {
+    std::size_t n = shared.Pop(batch.data(), batch.size());
+    for (std::size_t i = 0; i < n; ++i) threadOrder &= (batch[i] == received++);
+    if (n == 0) std::this_thread::yield();
+  }
+  producer.join();
+  Check(threadOrder, "items passed between threads keep their order");
+  Check(shared.Empty(), "queue is empty after the consumer took all items");
+
+  if (failures == 0) std::printf("SpscQueue: all checks pass\n");
+  return failures == 0 ? 0 : 1;
+}